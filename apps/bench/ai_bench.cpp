@@ -0,0 +1,410 @@
+/*
+ * Micro-Benchmarks für Serializer, Command-Parser und Command-Queue.
+ *
+ * Läuft ohne Worldserver: die "Welt" ist ein synthetischer Satz Player und
+ * Mobs, der sich pro Tick ungefähr so ändert wie im Spiel (ein Teil der Bots
+ * läuft, ein Teil kämpft, die Mob-Liste ändert sich selten). Gemessen wird
+ * genau der Modul-Code aus src/, damit Regressionen vor dem Deploy auffallen.
+ * Bauen mit apps/bench/build.sh.
+ *
+ *   ai_bench [--players N] [--mobs N] [--ticks N] [--commands N] [--producers N] [--capacity N]
+ *
+ * Ausgabe pro Benchmark: Anzahl, avg/p50/p99/max in ns pro Operation und bei
+ * Frames die durchschnittliche Größe. Die Perzentile kommen aus AIHistogram
+ * und haben dieselbe Auflösung (~20%) wie .aicontroller stats.
+ */
+
+#include "AIController.h"
+#include "AIMetrics.h"
+#include "AIProtocol.h"
+#include "AIState.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    uint64 ElapsedNs(Clock::time_point start)
+    {
+        return uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    struct BenchOptions
+    {
+        uint32 players = 100;
+        uint32 mobs = 10;           // Pro Player
+        uint32 ticks = 2000;
+        uint32 commands = 200000;   // Parser und Queue
+        uint32 producers = 2;       // Netzwerk-Threads
+        uint32 capacity = 1 << 20;  // Wie AIController.CommandQueue.Capacity; Default groß, damit nur der Durchsatz zählt
+    };
+
+    void PrintHeader()
+    {
+        std::printf("%-22s %10s %10s %10s %10s %10s %12s\n", "benchmark", "count", "avg_ns", "p50_ns", "p99_ns", "max_ns", "bytes");
+    }
+
+    void PrintResult(char const* name, AIHistogram const& histogram, uint64 bytes = 0)
+    {
+        uint64 count = histogram.GetCount();
+        std::printf("%-22s %10llu %10llu %10llu %10llu %10llu", name, (unsigned long long)count,
+            (unsigned long long)(count ? histogram.GetSum() / count : 0), (unsigned long long)histogram.GetPercentile(0.5),
+            (unsigned long long)histogram.GetPercentile(0.99), (unsigned long long)histogram.GetMax());
+        if (bytes)
+            std::printf(" %12llu", (unsigned long long)(count ? bytes / count : 0));
+        std::printf("\n");
+    }
+
+    // --- MOCK WORLD ---
+
+    // Was sonst Player, Perception und Events liefern
+    struct MockBot
+    {
+        std::string name;
+        AIPlayerRecord record;
+        std::vector<AIMobRecord> mobs;
+        std::string mobsJson;
+        bool moving = false;
+        bool fighting = false;
+    };
+
+    class MockWorld
+    {
+    public:
+        MockWorld(uint32 players, uint32 mobs) : _rng(42)
+        {
+            _bots.resize(players);
+            for (uint32 i = 0; i < players; ++i)
+            {
+                MockBot& bot = _bots[i];
+                char name[16];
+                std::snprintf(name, sizeof(name), "Bot%05u", i);
+                bot.name = name;
+                CopyRecordName(bot.record.name, bot.name);
+                bot.record.guid = 1000 + i;
+                bot.record.handle = i;
+                bot.record.hp = bot.record.maxHp = 1500;
+                bot.record.power = bot.record.maxPower = 2000;
+                bot.record.level = 20;
+                bot.record.freeSlots = 40;
+                bot.record.x = -8949.95f + float(i % 50);
+                bot.record.y = -132.49f + float(i / 50);
+                bot.record.z = 83.53f;
+                bot.moving = i % 3 == 0;
+                bot.fighting = i % 4 == 0;
+
+                bot.mobs.resize(mobs);
+                for (uint32 m = 0; m < mobs; ++m)
+                {
+                    AIMobRecord& mob = bot.mobs[m];
+                    mob.guid = 0xF130000000000000ull + i * 1000 + m;
+                    mob.entry = 299 + m;
+                    mob.hp = 120;
+                    mob.level = 5;
+                    mob.flags = AI_MOB_FLAG_ATTACKABLE;
+                    mob.x = bot.record.x + float(m);
+                    mob.y = bot.record.y - float(m);
+                    mob.z = bot.record.z;
+                }
+                BuildMobsJson(bot);
+            }
+        }
+
+        // Ein World-Tick: Läufer bewegen sich, Kämpfer verlieren HP, selten ändern sich Mobs
+        void Tick()
+        {
+            std::uniform_int_distribution<uint32> roll(0, 99);
+            for (MockBot& bot : _bots)
+            {
+                AIPlayerRecord& rec = bot.record;
+                if (bot.moving)
+                {
+                    rec.x += 0.7f;
+                    rec.o = float(roll(_rng)) * 0.0628f;
+                }
+                if (bot.fighting)
+                {
+                    rec.flags |= AI_PLAYER_FLAG_COMBAT;
+                    rec.hp = rec.hp > 30 ? rec.hp - 30 : rec.maxHp;
+                    rec.targetStatus = AI_TARGET_ALIVE;
+                    rec.targetHp = 60 + roll(_rng);
+                    if (!bot.mobs.empty())
+                    {
+                        bot.mobs.front().hp = rec.targetHp;
+                        rec.tx = bot.mobs.front().x;
+                        rec.ty = bot.mobs.front().y;
+                        rec.tz = bot.mobs.front().z;
+                    }
+                }
+                if (bot.fighting || roll(_rng) < 5)
+                    BuildMobsJson(bot);
+            }
+        }
+
+        void Publish(AIStateBuilder& builder)
+        {
+            for (MockBot const& bot : _bots)
+                builder.AddPlayer(bot.name, bot.record, bot.mobsJson, bot.mobs);
+        }
+
+        std::vector<MockBot> const& GetBots() const { return _bots; }
+
+    private:
+        // Dasselbe Format wie AIPerceptionCache
+        static void BuildMobsJson(MockBot& bot)
+        {
+            bot.mobsJson.clear();
+            AIJsonWriter json(bot.mobsJson);
+            json.Char('[');
+            for (std::size_t m = 0; m < bot.mobs.size(); ++m)
+            {
+                AIMobRecord const& mob = bot.mobs[m];
+                if (m) json.Raw(", ");
+                json.Raw("{\"guid\": \""); json.Number(mob.guid);
+                json.Raw("\", \"name\": "); json.String("Kobold Vermin");
+                json.Raw(", \"level\": "); json.Number(uint32(mob.level));
+                json.Raw(", \"attackable\": 1, \"vendor\": 0, \"target\": \""); json.Number(mob.target);
+                json.Raw("\", \"hp\": "); json.Number(mob.hp);
+                json.Raw(", \"x\": "); json.Number(mob.x);
+                json.Raw(", \"y\": "); json.Number(mob.y);
+                json.Raw(", \"z\": "); json.Number(mob.z);
+                json.Char('}');
+            }
+            json.Char(']');
+        }
+
+        std::vector<MockBot> _bots;
+        std::mt19937 _rng;
+    };
+
+    // --- SERIALIZER ---
+
+    void BenchSerializer(BenchOptions const& options)
+    {
+        MockWorld world(options.players, options.mobs);
+        AIStateBuilder builder;
+
+        AISubscription subscription;
+        subscription.Parse("0-9 vitals,position");
+
+        AIHistogram build, keyframe, delta, binary, subscribed;
+        uint64 buildBytes = 0, keyframeBytes = 0, deltaBytes = 0, binaryBytes = 0, subscribedBytes = 0;
+
+        // Wie die Clients: der vorherige Snapshot bleibt als Delta-Basis referenziert
+        AIStateSnapshotPtr previous;
+        for (uint32 tick = 1; tick <= options.ticks; ++tick)
+        {
+            world.Tick();
+
+            Clock::time_point start = Clock::now();
+            builder.Begin();
+            world.Publish(builder);
+            AIStateSnapshotPtr current = builder.Finish(tick);
+            build.Record(ElapsedNs(start));
+            buildBytes += current->json.size();
+
+            start = Clock::now();
+            std::string frame = BuildKeyframe(*current);
+            keyframe.Record(ElapsedNs(start));
+            keyframeBytes += frame.size();
+
+            if (previous)
+            {
+                start = Clock::now();
+                frame = BuildDeltaFrame(*previous, *current);
+                delta.Record(ElapsedNs(start));
+                deltaBytes += frame.size();
+            }
+
+            start = Clock::now();
+            frame = EncodeBinaryState(*current);
+            binary.Record(ElapsedNs(start));
+            binaryBytes += frame.size();
+
+            start = Clock::now();
+            frame = BuildFullFrame(*current, subscription);
+            subscribed.Record(ElapsedNs(start));
+            subscribedBytes += frame.size();
+
+            previous = std::move(current);
+        }
+
+        std::printf("\nserializer: %u players, %u mobs each, %u ticks (ns per frame)\n", options.players, options.mobs, options.ticks);
+        PrintHeader();
+        PrintResult("snapshot_build", build, buildBytes);
+        PrintResult("json_keyframe", keyframe, keyframeBytes);
+        PrintResult("json_delta", delta, deltaBytes);
+        PrintResult("binary_state", binary, binaryBytes);
+        PrintResult("json_subscribed_10", subscribed, subscribedBytes);
+    }
+
+    // --- PARSER ---
+
+    // Einzelne Aufrufe liegen nahe an der Auflösung der Uhr, daher in Blöcken messen
+    constexpr uint32 ParseBlockSize = 256;
+
+    void BenchParser(BenchOptions const& options)
+    {
+        static char const* const Lines[] =
+        {
+            "Bot00001:move_to:-8949.95:-132.49:83.53",
+            "Bot00002:cast:585",
+            "#3:target_nearest:30",
+            "#4:9:-8940.5:-130.25:83.5",
+            "Bot00005:target_guid:17379391008889585664",
+            "Bot00006:say:hello world",
+            "#7:loot_all:",
+            "Bot00008:reset:12"
+        };
+        constexpr std::size_t LineCount = sizeof(Lines) / sizeof(Lines[0]);
+
+        // AI_FRAME_BOT_COMMAND move_to: uint32 handle, uint8 action, float x, y, z
+        char payload[4 + 1 + 12];
+        uint32 handle = 3;
+        uint8 action = AI_ACTION_MOVE_TO;
+        float position[3] = { -8949.95f, -132.49f, 83.53f };
+        std::memcpy(payload, &handle, 4);
+        std::memcpy(payload + 4, &action, 1);
+        std::memcpy(payload + 5, position, sizeof(position));
+
+        AIHistogram text, binary;
+        uint32 textOk = 0, binaryOk = 0;
+        for (uint32 done = 0; done < options.commands; done += ParseBlockSize)
+        {
+            // Der letzte Block ist kürzer, damit genau options.commands Aufrufe pro Parser laufen
+            uint32 block = std::min(ParseBlockSize, options.commands - done);
+
+            Clock::time_point start = Clock::now();
+            for (uint32 i = 0; i < block; ++i)
+            {
+                AICommand cmd;
+                textOk += ParseTextCommand(Lines[(done + i) % LineCount], cmd);
+            }
+            text.Record(ElapsedNs(start) / block);
+
+            start = Clock::now();
+            for (uint32 i = 0; i < block; ++i)
+            {
+                AICommand cmd;
+                binaryOk += DecodeBinaryCommand(AI_FRAME_BOT_COMMAND, payload, sizeof(payload), cmd);
+            }
+            binary.Record(ElapsedNs(start) / block);
+        }
+
+        std::printf("\nparser: %u commands, %u text ok, %u binary ok (ns per command, blocks of %u)\n",
+            options.commands, textOk, binaryOk, ParseBlockSize);
+        PrintHeader();
+        PrintResult("parse_text", text);
+        PrintResult("decode_binary", binary);
+    }
+
+    // --- QUEUE ---
+
+    // Produzenten wie die Netzwerk-Threads, ein Konsument wie der World-Thread
+    void BenchQueue(BenchOptions const& options)
+    {
+        AICommandQueue queue(options.capacity);
+        AICommand prototype;
+        ParseTextCommand("Bot00001:move_to:-8949.95:-132.49:83.53", prototype);
+
+        uint32 perProducer = options.commands / std::max<uint32>(options.producers, 1);
+        uint64 total = uint64(perProducer) * options.producers;
+
+        Clock::time_point start = Clock::now();
+        std::vector<std::thread> producers;
+        for (uint32 p = 0; p < options.producers; ++p)
+        {
+            producers.emplace_back([&queue, &prototype, perProducer]()
+            {
+                for (uint32 i = 0; i < perProducer; ++i)
+                {
+                    AICommand cmd = prototype;
+                    cmd.receivedAt = Clock::now();
+                    queue.Push(std::move(cmd));
+                }
+            });
+        }
+
+        AIHistogram latency, batchSize;
+        std::vector<AICommand> batch;
+        uint64 taken = 0, dropped = 0;
+        while (taken + dropped < total)
+        {
+            batch.clear();
+            queue.TakeAll(batch);
+            dropped += queue.ConsumeDropped();
+            if (batch.empty())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            Clock::time_point now = Clock::now();
+            for (AICommand const& cmd : batch)
+                latency.Record(uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(now - cmd.receivedAt).count()));
+            batchSize.Record(batch.size());
+            taken += batch.size();
+        }
+        uint64 elapsed = ElapsedNs(start);
+
+        for (std::thread& producer : producers)
+            producer.join();
+
+        std::printf("\nqueue: %u producers, %llu commands, %llu dropped (capacity %u), %.0f commands/s\n", options.producers,
+            (unsigned long long)total, (unsigned long long)dropped, options.capacity, elapsed ? double(taken) * 1e9 / double(elapsed) : 0.0);
+        PrintHeader();
+        PrintResult("push_to_take", latency);
+        std::printf("%-22s %10llu %10llu %10llu %10llu %10llu\n", "batch_size", (unsigned long long)batchSize.GetCount(),
+            (unsigned long long)(batchSize.GetCount() ? batchSize.GetSum() / batchSize.GetCount() : 0),
+            (unsigned long long)batchSize.GetPercentile(0.5), (unsigned long long)batchSize.GetPercentile(0.99),
+            (unsigned long long)batchSize.GetMax());
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            uint32 value = uint32(std::strtoul(argv[i + 1], nullptr, 10));
+            std::string_view name = argv[i];
+            if (name == "--players")
+                options.players = value;
+            else if (name == "--mobs")
+                options.mobs = value;
+            else if (name == "--ticks")
+                options.ticks = std::max<uint32>(value, 1);
+            else if (name == "--commands")
+                options.commands = value;
+            else if (name == "--producers")
+                options.producers = std::max<uint32>(value, 1);
+            else if (name == "--capacity")
+                options.capacity = std::max<uint32>(value, 1);
+            else
+                return false;
+        }
+        return argc % 2 == 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--players N] [--mobs N] [--ticks N] [--commands N] [--producers N] [--capacity N]\n", argv[0]);
+        return 1;
+    }
+
+    BenchSerializer(options);
+    BenchParser(options);
+    BenchQueue(options);
+    return 0;
+}
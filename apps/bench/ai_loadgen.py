@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""
+Lastgenerator für den Socket von mod-ai-controller.
+
+Öffnet N Clients gegen einen laufenden Worldserver, jeder schickt M Kommandos
+pro Sekunde im Text-Protokoll ("playerName:actionType:value"). Gemessen werden
+State-Frames/s und Bytes/s pro Client, die Latenz Kommando -> Beobachtung und
+die CPU-Zeit des Worldservers.
+
+Latenz: jedes Kommando geht als Step mit einem Kommando raus ("@step <id>",
+Kommando, "@end"). Der Server bestätigt den Step direkt vor dem ersten
+State-Frame, der seine Wirkung enthält; Senden bis Ack ist also genau die
+Latenz, die ein Agent sieht.
+
+    python3 apps/bench/ai_loadgen.py --clients 8 --rate 200 --duration 30 --mode delta
+
+Nur Standardbibliothek. Mit --metrics kommt am Ende zusätzlich der Report des
+Servers ("@metrics", siehe AIController.Metrics.Enable).
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import time
+
+STATE_TYPES = ("keyframe", "delta")
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    index = min(len(values) - 1, max(0, int(round(p * len(values))) - 1))
+    return values[index]
+
+
+def find_worldserver_pid():
+    for entry in os.listdir("/proc"):
+        if not entry.isdigit():
+            continue
+        try:
+            with open(f"/proc/{entry}/comm") as f:
+                if f.read().strip() == "worldserver":
+                    return int(entry)
+        except OSError:
+            continue
+    return None
+
+
+def read_cpu_seconds(pid):
+    """utime + stime in Sekunden, None wenn nicht lesbar (anderer Host, kein /proc)."""
+    try:
+        with open(f"/proc/{pid}/stat") as f:
+            fields = f.read().rsplit(")", 1)[1].split()
+        return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+    except (OSError, IndexError, ValueError):
+        return None
+
+
+class ClientStats:
+    def __init__(self):
+        self.state_frames = 0
+        self.heartbeats = 0
+        self.bytes = 0
+        self.sent = 0
+        self.acked = 0
+        self.dropped = 0
+        self.latencies = []
+
+
+class LoadClient:
+    def __init__(self, index, args, bots):
+        self.index = index
+        self.args = args
+        self.bots = bots
+        self.stats = ClientStats()
+        self.pending = {}
+        self.positions = {}
+        self.metrics = None
+        self.rng = random.Random(index)
+        self.next_step = index << 32
+
+    async def run(self, deadline):
+        reader, writer = await asyncio.open_connection(self.args.host, self.args.port, limit=64 * 1024 * 1024)
+        if self.args.mode == "delta":
+            writer.write(b"@delta\n")
+        if self.args.subscribe:
+            writer.write(f"@subscribe {self.args.subscribe}\n".encode())
+        await writer.drain()
+
+        receiver = asyncio.create_task(self.receive(reader))
+        try:
+            await self.send(writer, deadline)
+            # Auf die letzten Acks warten
+            await asyncio.sleep(self.args.drain)
+            if self.args.metrics and self.index == 0:
+                writer.write(b"@metrics\n")
+                await writer.drain()
+                await asyncio.sleep(0.5)
+        finally:
+            receiver.cancel()
+            writer.close()
+
+    async def send(self, writer, deadline):
+        loop = asyncio.get_running_loop()
+        interval = 1.0 / self.args.rate
+        next_send = loop.time()
+        while loop.time() < deadline:
+            lines = []
+            now = loop.time()
+            # Ohne Drift: alle fälligen Kommandos auf einmal, falls der Loop hinterherhängt
+            while next_send <= now:
+                step = self.next_step
+                self.next_step += 1
+                self.pending[step] = time.perf_counter()
+                lines.append(f"@step {step}\n{self.make_command()}\n@end\n")
+                next_send += interval
+            if lines:
+                writer.write("".join(lines).encode())
+                self.stats.sent += len(lines)
+                await writer.drain()
+            await asyncio.sleep(max(0.0, next_send - loop.time()))
+
+    def make_command(self):
+        bot = self.rng.choice(self.bots)
+        action = self.rng.choice(self.args.actions)
+        if action == "move_to":
+            x, y, z = self.positions.get(bot, (None, None, None))
+            if x is None:
+                return f"{bot}:target_nearest:"
+            return f"{bot}:move_to:{x + self.rng.uniform(-5, 5):.2f}:{y + self.rng.uniform(-5, 5):.2f}:{z:.2f}"
+        if action == "say":
+            return f"{bot}:say:loadgen"
+        if action == "cast":
+            return f"{bot}:cast:{self.args.spell}"
+        return f"{bot}:{action}:"
+
+    async def receive(self, reader):
+        while True:
+            line = await reader.readline()
+            if not line:
+                return
+            self.stats.bytes += len(line)
+            try:
+                frame = json.loads(line)
+            except ValueError:
+                continue
+            kind = frame.get("type")
+            if kind == "step":
+                sent_at = self.pending.pop(frame.get("step"), None)
+                if sent_at is not None:
+                    self.stats.latencies.append(time.perf_counter() - sent_at)
+                if frame.get("status") == "applied":
+                    self.stats.acked += 1
+                else:
+                    self.stats.dropped += 1
+            elif kind == "heartbeat":
+                self.stats.heartbeats += 1
+            elif kind == "metrics":
+                self.metrics = frame.get("text", "")
+            elif kind in STATE_TYPES or (kind is None and "players" in frame):
+                self.stats.state_frames += 1
+                self.track_positions(frame.get("players", []))
+
+    def track_positions(self, players):
+        for player in players:
+            name = player.get("name")
+            if name in self.positions or ("x" in player and "y" in player and "z" in player):
+                x, y, z = self.positions.get(name, (0.0, 0.0, 0.0))
+                self.positions[name] = (float(player.get("x", x)), float(player.get("y", y)), float(player.get("z", z)))
+
+
+async def fetch_roster(args):
+    """Bot-Namen über "@roster", wenn keine --bots angegeben sind."""
+    reader, writer = await asyncio.open_connection(args.host, args.port, limit=64 * 1024 * 1024)
+    writer.write(b"@roster\n")
+    await writer.drain()
+    try:
+        while True:
+            line = await asyncio.wait_for(reader.readline(), timeout=5.0)
+            if not line:
+                return []
+            try:
+                frame = json.loads(line)
+            except ValueError:
+                continue
+            if frame.get("type") == "roster":
+                return [bot["name"] for bot in frame.get("bots", [])]
+    except asyncio.TimeoutError:
+        return []
+    finally:
+        writer.close()
+
+
+async def main(args):
+    bots = [name for name in args.bots.split(",") if name] if args.bots else await fetch_roster(args)
+    if not bots:
+        print("No bots: pass --bots or log bots in (AIController.Spawn.Roster).")
+        return 1
+
+    pid = args.pid or find_worldserver_pid()
+    cpu_start = read_cpu_seconds(pid) if pid else None
+
+    clients = [LoadClient(i, args, bots) for i in range(args.clients)]
+    loop = asyncio.get_running_loop()
+    started = loop.time()
+    deadline = started + args.duration
+    await asyncio.gather(*(client.run(deadline) for client in clients))
+    elapsed = loop.time() - started
+
+    cpu_end = read_cpu_seconds(pid) if pid else None
+
+    print(f"{args.clients} clients x {args.rate} commands/s, {len(bots)} bots, mode {args.mode}, {elapsed:.1f}s")
+    print(f"{'client':>6} {'frames/s':>9} {'KiB/s':>9} {'sent':>8} {'acked':>8} {'dropped':>8} {'p50_ms':>8} {'p99_ms':>8} {'max_ms':>8}")
+    all_latencies = []
+    total = ClientStats()
+    for client in clients:
+        s = client.stats
+        all_latencies += s.latencies
+        total.state_frames += s.state_frames
+        total.bytes += s.bytes
+        total.sent += s.sent
+        total.acked += s.acked
+        total.dropped += s.dropped
+        print(f"{client.index:>6} {s.state_frames / elapsed:>9.1f} {s.bytes / 1024 / elapsed:>9.1f} {s.sent:>8} {s.acked:>8} {s.dropped:>8}"
+              f" {percentile(s.latencies, 0.5) * 1000:>8.2f} {percentile(s.latencies, 0.99) * 1000:>8.2f} {max(s.latencies, default=0) * 1000:>8.2f}")
+    print(f"{'total':>6} {total.state_frames / elapsed:>9.1f} {total.bytes / 1024 / elapsed:>9.1f} {total.sent:>8} {total.acked:>8} {total.dropped:>8}"
+          f" {percentile(all_latencies, 0.5) * 1000:>8.2f} {percentile(all_latencies, 0.99) * 1000:>8.2f} {max(all_latencies, default=0) * 1000:>8.2f}")
+
+    lost = total.sent - total.acked - total.dropped
+    if lost:
+        print(f"{lost} steps without ack (still queued at the end or connection closed)")
+
+    if cpu_start is not None and cpu_end is not None:
+        print(f"worldserver (pid {pid}) CPU: {(cpu_end - cpu_start) / elapsed * 100:.1f}% of one core")
+    else:
+        print("worldserver CPU: not available (pass --pid when the server runs on this host)")
+
+    if clients and clients[0].metrics:
+        print("\nserver metrics:")
+        print(clients[0].metrics)
+    return 0
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Load generator for the mod-ai-controller socket protocol.")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=5000)
+    parser.add_argument("--clients", type=int, default=4, help="parallel connections")
+    parser.add_argument("--rate", type=float, default=50.0, help="commands per second per client")
+    parser.add_argument("--duration", type=float, default=10.0, help="seconds of load")
+    parser.add_argument("--drain", type=float, default=1.0, help="seconds to wait for outstanding acks")
+    parser.add_argument("--mode", choices=("full", "delta"), default="full")
+    parser.add_argument("--subscribe", default="", help='per-client "@subscribe" argument, e.g. "0-9 vitals,position"')
+    parser.add_argument("--bots", default="", help="comma-separated bot names (default: roster from the server)")
+    parser.add_argument("--actions", default="move_to,target_nearest",
+                        help="comma-separated actions picked at random (move_to, target_nearest, say, cast, ...)")
+    parser.add_argument("--spell", type=int, default=585, help="spell id for cast")
+    parser.add_argument("--pid", type=int, default=0, help="worldserver pid for CPU usage (default: search /proc)")
+    parser.add_argument("--metrics", action="store_true", help='print the server report ("@metrics") at the end')
+    args = parser.parse_args()
+    args.actions = [action for action in args.actions.split(",") if action]
+    args.rate = max(args.rate, 0.1)
+    return args
+
+
+if __name__ == "__main__":
+    raise SystemExit(asyncio.run(main(parse_args())))
@@ -0,0 +1,37 @@
+#!/bin/bash
+#
+# Baut apps/bench/ai_bench ohne Worldserver.
+#
+# Gebraucht werden nur die Header aus src/common des Cores (Define.h,
+# CompilerDefs.h). Liegt das Modul wie üblich unter <core>/modules/, wird der
+# Core automatisch gefunden, sonst ACORE_ROOT setzen.
+#
+#   ./apps/bench/build.sh && ./apps/bench/build/ai_bench --players 500
+#
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+MOD_DIR="$(cd "$BENCH_DIR/../.." && pwd)"
+ACORE_ROOT="${ACORE_ROOT:-$MOD_DIR/../..}"
+CXX="${CXX:-g++}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/build}"
+
+if [ ! -f "$ACORE_ROOT/src/common/Define.h" ]; then
+    echo "Define.h not found in $ACORE_ROOT/src/common, set ACORE_ROOT to the AzerothCore source directory."
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+
+# Nur die Teile des Moduls, die keine Weltobjekte anfassen
+"$CXX" -std=c++20 -O2 -DNDEBUG -pthread -Wall -Wextra \
+    -I"$ACORE_ROOT/src/common" -I"$MOD_DIR/src" \
+    "$BENCH_DIR/ai_bench.cpp" \
+    "$MOD_DIR/src/AICommandQueue.cpp" \
+    "$MOD_DIR/src/AIMetrics.cpp" \
+    "$MOD_DIR/src/AIProtocol.cpp" \
+    "$MOD_DIR/src/AIState.cpp" \
+    -o "$OUT_DIR/ai_bench"
+
+echo "Built $OUT_DIR/ai_bench"
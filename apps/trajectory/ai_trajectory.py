@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+Leser für die Trajektorien-Dateien von mod-ai-controller (AIController.Record.Enable).
+
+Die Dateien werden per mmap geöffnet, jede Spalte ist ein memoryview direkt
+auf die Datei, ohne Kopie und ohne Parsen. Mit numpy wird daraus per
+np.asarray(block.players["hp"]) ebenfalls ohne Kopie ein Array. Das Format
+ist in src/AITrajectory.h beschrieben.
+
+    from ai_trajectory import TrajectoryReader
+    for state, commands, next_state in TrajectoryReader("trajectories").transitions():
+        ...
+
+Als Tool: Übersicht über eine Aufnahme bzw. die ersten Kommandos.
+
+    python3 apps/trajectory/ai_trajectory.py trajectories/
+    python3 apps/trajectory/ai_trajectory.py --commands 20 trajectories/trajectory-*.aitr
+"""
+
+import argparse
+import mmap
+import os
+import struct
+
+MAGIC = b"AITRAJ01"
+FORMAT_VERSION = 1
+RECORD_STATE = 1
+RECORD_COMMANDS = 2
+
+# (Name, struct-Format) in Schreibreihenfolge, siehe StateColumns/CommandColumns in AITrajectory.cpp
+PLAYER_COLUMNS = (
+    ("guid", "Q"), ("handle", "I"), ("hp", "I"), ("max_hp", "I"), ("power", "I"), ("max_power", "I"),
+    ("level", "B"), ("flags", "B"), ("free_slots", "I"), ("x", "f"), ("y", "f"), ("z", "f"), ("o", "f"),
+    ("target_status", "B"), ("target_hp", "I"), ("tx", "f"), ("ty", "f"), ("tz", "f"),
+    ("xp_gained", "I"), ("loot_copper", "I"), ("loot_score", "I"), ("mob_offset", "I"), ("mob_count", "I"),
+)
+MOB_COLUMNS = (
+    ("guid", "Q"), ("entry", "I"), ("hp", "I"), ("target", "Q"),
+    ("x", "f"), ("y", "f"), ("z", "f"), ("level", "B"), ("flags", "B"),
+)
+COMMAND_COLUMNS = (
+    ("guid", "Q"), ("handle", "I"), ("session", "I"), ("step", "Q"), ("action", "B"),
+    ("x", "f"), ("y", "f"), ("z", "f"), ("range", "f"), ("spell", "I"), ("target", "Q"), ("episode", "Q"),
+)
+
+# AIAction, siehe AIProtocol.h
+ACTION_NAMES = (
+    "none", "say", "stop", "turn_left", "turn_right", "move_forward", "target_nearest", "cast", "reset",
+    "move_to", "target_guid", "loot_guid", "sell_grey", "spawn", "checkpoint", "reset_batch",
+    "loot_all", "attack", "vendor_run",
+)
+
+FILE_HEADER = struct.Struct("<8sIIQI")
+RECORD_HEADER = struct.Struct("<IB3x")
+BLOCK_HEADER = struct.Struct("<QQII")
+
+
+def _align8(size):
+    return (size + 7) & ~7
+
+
+def _columns(view, offset, count, layout):
+    columns = {}
+    for name, fmt in layout:
+        size = struct.calcsize(fmt) * count
+        columns[name] = view[offset:offset + size].cast(fmt)
+        offset += _align8(size)
+    return columns, offset
+
+
+class StateBlock:
+    """Ein Snapshot; players/mobs bilden Spaltenname -> memoryview."""
+
+    def __init__(self, version, time_ms, players, mobs, player_count, mob_count):
+        self.version = version
+        self.time_ms = time_ms
+        self.players = players
+        self.mobs = mobs
+        self.player_count = player_count
+        self.mob_count = mob_count
+
+    def mobs_of(self, player):
+        """Spalten der Mobs von Player-Index player (wieder ohne Kopie)."""
+        start = self.players["mob_offset"][player]
+        end = start + self.players["mob_count"][player]
+        return {name: column[start:end] for name, column in self.mobs.items()}
+
+
+class CommandBlock:
+    """Alle in einem Tick angewendeten Kommandos, nach dem Snapshot version."""
+
+    def __init__(self, version, time_ms, commands, count):
+        self.version = version
+        self.time_ms = time_ms
+        self.commands = commands
+        self.count = count
+
+
+def read_segment(path):
+    """Liefert StateBlock/CommandBlock einer Datei; eine noch offene Datei endet beim ersten length 0."""
+    with open(path, "rb") as f:
+        if os.fstat(f.fileno()).st_size < FILE_HEADER.size:
+            return
+        mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    view = memoryview(mm)
+    magic, version, header_size, _, _ = FILE_HEADER.unpack_from(view, 0)
+    if magic != MAGIC or version != FORMAT_VERSION:
+        raise ValueError(f"{path}: not a trajectory file (format {version})")
+
+    offset = header_size
+    while offset + RECORD_HEADER.size <= len(view):
+        length, kind = RECORD_HEADER.unpack_from(view, offset)
+        if not length or offset + RECORD_HEADER.size + length > len(view):
+            break
+        payload = offset + RECORD_HEADER.size
+        block_version, time_ms, count, extra = BLOCK_HEADER.unpack_from(view, payload)
+        columns_at = payload + BLOCK_HEADER.size
+        if kind == RECORD_STATE:
+            players, mobs_at = _columns(view, columns_at, count, PLAYER_COLUMNS)
+            mobs, _ = _columns(view, mobs_at, extra, MOB_COLUMNS)
+            yield StateBlock(block_version, time_ms, players, mobs, count, extra)
+        elif kind == RECORD_COMMANDS:
+            commands, _ = _columns(view, columns_at, count, COMMAND_COLUMNS)
+            yield CommandBlock(block_version, time_ms, commands, count)
+        offset = payload + length
+
+
+class TrajectoryReader:
+    """Liest eine Aufnahme über alle Segmente; path ist ein Verzeichnis oder eine Liste von Dateien."""
+
+    def __init__(self, path):
+        if isinstance(path, (list, tuple)):
+            files = list(path)
+        elif os.path.isdir(path):
+            files = [os.path.join(path, name) for name in os.listdir(path) if name.endswith(".aitr")]
+        else:
+            files = [path]
+        # trajectory-<start>-<segment>.aitr: Aufnahmen und Segmente in Reihenfolge
+        self.files = sorted(files, key=lambda name: os.path.basename(name))
+
+    def __iter__(self):
+        for path in self.files:
+            yield from read_segment(path)
+
+    def states(self):
+        return (block for block in self if isinstance(block, StateBlock))
+
+    def transitions(self):
+        """(state, [CommandBlock, ...], next_state): was zwischen zwei Snapshots angewendet wurde."""
+        state = None
+        pending = []
+        for block in self:
+            if isinstance(block, CommandBlock):
+                pending.append(block)
+                continue
+            if state is not None:
+                yield state, pending, block
+            state = block
+            pending = []
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize mod-ai-controller trajectory files.")
+    parser.add_argument("paths", nargs="+", help="recording directory or .aitr files")
+    parser.add_argument("--commands", type=int, default=0, help="print the first N commands")
+    args = parser.parse_args()
+
+    reader = TrajectoryReader(args.paths[0] if len(args.paths) == 1 else args.paths)
+    states = commands = players = mobs = 0
+    first_ms = last_ms = None
+    printed = 0
+    for block in reader:
+        first_ms = block.time_ms if first_ms is None else first_ms
+        last_ms = block.time_ms
+        if isinstance(block, StateBlock):
+            states += 1
+            players += block.player_count
+            mobs += block.mob_count
+            continue
+        commands += block.count
+        for i in range(block.count):
+            if printed >= args.commands:
+                break
+            c = block.commands
+            action = ACTION_NAMES[c["action"][i]] if c["action"][i] < len(ACTION_NAMES) else c["action"][i]
+            print(f"t={block.time_ms} after v{block.version} handle={c['handle'][i]} guid={c['guid'][i]} "
+                  f"step={c['step'][i]} {action} x={c['x'][i]:.3f} y={c['y'][i]:.3f} z={c['z'][i]:.3f} "
+                  f"spell={c['spell'][i]} target={c['target'][i]}")
+            printed += 1
+
+    print(f"{len(reader.files)} segments, {states} snapshots, {commands} commands")
+    if states:
+        print(f"{players / states:.1f} players and {mobs / states:.1f} mobs per snapshot")
+    if first_ms is not None:
+        print(f"{(last_ms - first_ms) / 1000:.1f}s recorded")
+
+
+if __name__ == "__main__":
+    main()
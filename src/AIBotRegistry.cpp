@@ -0,0 +1,188 @@
+#include "AIBotRegistry.h"
+#include "Player.h"
+#include "WorldSession.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+std::string const AIBotRegistry::TagKey = "mod-ai-controller.bot";
+
+AIBotRegistry* AIBotRegistry::instance()
+{
+    static AIBotRegistry instance;
+    return &instance;
+}
+
+std::string AIBotRegistry::MakeNameKey(std::string_view name)
+{
+    // Wie ObjectAccessor::FindPlayerByName: Groß-/Kleinschreibung egal
+    std::string key(name);
+    for (char& c : key)
+        c = char(std::tolower(static_cast<unsigned char>(c)));
+    return key;
+}
+
+void AIBotRegistry::IndexName(AIBotEntry& entry, std::string_view name)
+{
+    if (!entry.nameKey.empty())
+        _byName.erase(entry.nameKey);
+
+    entry.name = std::string(name);
+    entry.nameKey = MakeNameKey(name);
+    _byName[entry.nameKey] = &entry;
+}
+
+AIBotEntry* AIBotRegistry::Register(uint32 accountId, ObjectGuid guid, std::string_view name, WorldSession* session)
+{
+    if (_byAccount.find(accountId) != _byAccount.end())
+        return nullptr;
+
+    uint32 index;
+    if (!_freeSlots.empty())
+    {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        index = uint32(_slots.size());
+        _slots.emplace_back();
+    }
+
+    _slots[index] = std::make_unique<AIBotEntry>();
+    AIBotEntry& entry = *_slots[index];
+    entry.index = index;
+    entry.accountId = accountId;
+    entry.guid = guid;
+    entry.session = session;
+
+    _byAccount[accountId] = &entry;
+    _bySession[session] = &entry;
+    _byGuid[guid.GetRawValue()] = &entry;
+    IndexName(entry, name);
+    return &entry;
+}
+
+void AIBotRegistry::BindPlayer(AIBotEntry& entry, Player* player)
+{
+    entry.player = player;
+    _rosterChanged = true;
+    entry.events.Clear();
+    entry.inventory.MarkDirty();
+    player->CustomData.Set(TagKey, new AIBotTag(entry.index, &entry.events, &entry.inventory));
+
+    // Den Namen so übernehmen, wie er in der DB steht
+    if (player->GetName() != entry.name)
+        IndexName(entry, player->GetName());
+}
+
+void AIBotRegistry::UnbindPlayer(Player* player)
+{
+    AIBotTag const* tag = GetTag(player);
+    if (!tag)
+        return;
+
+    if (tag->index < _slots.size() && _slots[tag->index] && _slots[tag->index]->player == player)
+    {
+        _slots[tag->index]->player = nullptr;
+        _slots[tag->index]->checkpoint.reset();
+        _slots[tag->index]->macro.Clear();
+        _rosterChanged = true;
+    }
+
+    player->CustomData.Erase(TagKey);
+}
+
+void AIBotRegistry::Remove(uint32 accountId)
+{
+    auto itr = _byAccount.find(accountId);
+    if (itr == _byAccount.end())
+        return;
+
+    AIBotEntry* entry = itr->second;
+    _byAccount.erase(itr);
+    _bySession.erase(entry->session);
+    _byGuid.erase(entry->guid.GetRawValue());
+    _byName.erase(entry->nameKey);
+
+    delete entry->session;
+
+    uint32 index = entry->index;
+    if (entry->player)
+        _rosterChanged = true;
+    _slots[index].reset();
+    _freeSlots.push_back(index);
+}
+
+AIBotEntry* AIBotRegistry::FindByIndex(uint32 index) const
+{
+    return index < _slots.size() ? _slots[index].get() : nullptr;
+}
+
+AIBotEntry* AIBotRegistry::FindByAccount(uint32 accountId) const
+{
+    auto itr = _byAccount.find(accountId);
+    return itr != _byAccount.end() ? itr->second : nullptr;
+}
+
+AIBotEntry* AIBotRegistry::FindBySession(WorldSession const* session) const
+{
+    auto itr = _bySession.find(session);
+    return itr != _bySession.end() ? itr->second : nullptr;
+}
+
+AIBotEntry* AIBotRegistry::FindByGuid(ObjectGuid guid) const
+{
+    auto itr = _byGuid.find(guid.GetRawValue());
+    return itr != _byGuid.end() ? itr->second : nullptr;
+}
+
+AIBotEntry* AIBotRegistry::FindByName(std::string_view name) const
+{
+    auto itr = _byName.find(MakeNameKey(name));
+    return itr != _byName.end() ? itr->second : nullptr;
+}
+
+bool AIBotRegistry::ConsumeRosterChanged()
+{
+    bool changed = _rosterChanged;
+    _rosterChanged = false;
+    return changed;
+}
+
+void AIBotRegistry::BuildRoster(std::vector<AIRosterEntry>& out) const
+{
+    out.clear();
+    for (std::unique_ptr<AIBotEntry> const& entry : _slots)
+    {
+        if (!entry || !entry->player)
+            continue;
+
+        AIRosterEntry& bot = out.emplace_back();
+        bot.handle = entry->index;
+        bot.guid = entry->guid.GetRawValue();
+        CopyRecordName(bot.name, entry->name);
+    }
+}
+
+AIBotTag const* AIBotRegistry::GetTag(Player const* player)
+{
+    return player ? player->CustomData.Get<AIBotTag>(TagKey) : nullptr;
+}
+
+AIBotEvents* AIBotRegistry::GetEvents(Player const* player)
+{
+    AIBotTag const* tag = GetTag(player);
+    return tag ? tag->events : nullptr;
+}
+
+AIInventorySummary* AIBotRegistry::GetInventory(Player const* player)
+{
+    AIBotTag const* tag = GetTag(player);
+    return tag ? tag->inventory : nullptr;
+}
+
+bool AIBotRegistry::IsBot(Player const* player)
+{
+    return GetTag(player) != nullptr;
+}
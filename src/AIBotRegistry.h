@@ -0,0 +1,160 @@
+/*
+ * Registry aller vom Modul gespawnten Bots.
+ *
+ * Wird ausschließlich im World-Thread benutzt (Chat-Hook, Login-Callbacks aus
+ * ProcessReadyCallbacks, Command-Dispatch in OnUpdate) und braucht daher keinen
+ * Mutex. Lookups per Account, Session, GUID und Name sind O(1); zusätzlich
+ * trägt jeder eingeloggte Bot-Player ein Tag in seinen CustomData, sodass
+ * IsBot(player) ohne Registry-Zugriff auskommt.
+ */
+
+#ifndef MOD_AI_CONTROLLER_BOT_REGISTRY_H
+#define MOD_AI_CONTROLLER_BOT_REGISTRY_H
+
+#include "AIEpisode.h"
+#include "AIInventory.h"
+#include "AIMacro.h"
+#include "AIState.h"
+#include "DataMap.h"
+#include "Define.h"
+#include "ObjectGuid.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+class WorldSession;
+
+// Belohnungs-Events seit dem letzten Snapshot. Die Hooks laufen teils in
+// Map-Threads und zählen atomar hoch, der World-Thread leert per exchange.
+struct AIBotEvents
+{
+    std::atomic<uint32> xpGained{ 0 };
+    std::atomic<uint32> lootCopper{ 0 };
+    std::atomic<uint32> lootScore{ 0 };
+    std::atomic<uint8> flags{ 0 };      // AI_PLAYER_FLAG_LEVELED_UP, AI_PLAYER_FLAG_EQUIPPED_UPGRADE
+
+    // Nur World-Thread: Events in den Record übernehmen und zurücksetzen
+    void ConsumeInto(AIPlayerRecord& record)
+    {
+        record.xpGained = xpGained.exchange(0, std::memory_order_relaxed);
+        record.lootCopper = lootCopper.exchange(0, std::memory_order_relaxed);
+        record.lootScore = lootScore.exchange(0, std::memory_order_relaxed);
+        record.flags |= flags.exchange(0, std::memory_order_relaxed);
+    }
+
+    void Clear()
+    {
+        AIPlayerRecord discarded;
+        ConsumeInto(discarded);
+    }
+};
+
+struct AIBotEntry
+{
+    uint32 index = 0;                   // Stabiler Slot in der Registry
+    uint32 accountId = 0;
+    ObjectGuid guid;
+    std::string name;
+    std::string nameKey;                // Kleingeschrieben, Key für FindByName
+    WorldSession* session = nullptr;    // Gehört der Registry
+    Player* player = nullptr;           // Erst nach erfolgreichem Login gesetzt
+
+    // Ziel für "reset", per "checkpoint" gesetzt; gilt nur bis zum Logout
+    std::unique_ptr<AIEpisodeCheckpoint> checkpoint;
+
+    AIBotEvents events;
+    AIInventorySummary inventory;
+
+    // Laufendes Makro (loot_all, attack, vendor_run); endet beim Logout ohne Event
+    AIMacroState macro;
+};
+
+// Hängt am Player (CustomData) und markiert ihn als Bot. Die Hooks erreichen
+// darüber den Event-Slot, ohne die Registry (nur World-Thread) anzufassen.
+class AIBotTag : public DataMap::Base
+{
+public:
+    AIBotTag(uint32 index, AIBotEvents* events, AIInventorySummary* inventory) : index(index), events(events), inventory(inventory) { }
+
+    uint32 index;
+    AIBotEvents* events;
+    AIInventorySummary* inventory;
+};
+
+class AIBotRegistry
+{
+public:
+    static AIBotRegistry* instance();
+
+    // Beim Start des Logins; nullptr, wenn der Account schon registriert ist
+    AIBotEntry* Register(uint32 accountId, ObjectGuid guid, std::string_view name, WorldSession* session);
+
+    // Player ist geladen und in der Welt
+    void BindPlayer(AIBotEntry& entry, Player* player);
+
+    // Player loggt aus, die Session bleibt für einen erneuten Login registriert
+    void UnbindPlayer(Player* player);
+
+    // Gescheiterter Login: Eintrag entfernen und Session löschen
+    void Remove(uint32 accountId);
+
+    // Handle = Index, O(1) über den Slot-Vektor
+    AIBotEntry* FindByIndex(uint32 index) const;
+    AIBotEntry* FindByAccount(uint32 accountId) const;
+    AIBotEntry* FindBySession(WorldSession const* session) const;
+    AIBotEntry* FindByGuid(ObjectGuid guid) const;
+    AIBotEntry* FindByName(std::string_view name) const;
+
+    // Ohne Lock und ohne Scan, liest nur das Tag am Player
+    static bool IsBot(Player const* player);
+    static AIBotTag const* GetTag(Player const* player);
+
+    // nullptr für alle Nicht-Bots
+    static AIBotEvents* GetEvents(Player const* player);
+    static AIInventorySummary* GetInventory(Player const* player);
+
+    std::size_t GetCount() const { return _byAccount.size(); }
+
+    // Obergrenze für FindByIndex, freie Slots eingeschlossen
+    uint32 GetSlotCount() const { return uint32(_slots.size()); }
+
+    // Alle eingeloggten Bots in Handle-Reihenfolge
+    template<class Visitor>
+    void VisitOnline(Visitor&& visitor)
+    {
+        for (std::unique_ptr<AIBotEntry> const& entry : _slots)
+            if (entry && entry->player)
+                visitor(*entry);
+    }
+
+    // Eingeloggte Bots für den Roster; true, wenn er sich seit dem letzten Aufruf geändert hat
+    bool ConsumeRosterChanged();
+    void BuildRoster(std::vector<AIRosterEntry>& out) const;
+
+private:
+    AIBotRegistry() : _rosterChanged(false) { }
+
+    static std::string const TagKey;
+
+    static std::string MakeNameKey(std::string_view name);
+    void IndexName(AIBotEntry& entry, std::string_view name);
+
+    // Slots werden nach Remove wiederverwendet, Indizes bleiben stabil
+    std::vector<std::unique_ptr<AIBotEntry>> _slots;
+    std::vector<uint32> _freeSlots;
+
+    std::unordered_map<uint32, AIBotEntry*> _byAccount;
+    std::unordered_map<WorldSession const*, AIBotEntry*> _bySession;
+    std::unordered_map<uint64, AIBotEntry*> _byGuid;
+    std::unordered_map<std::string_view, AIBotEntry*> _byName;
+
+    bool _rosterChanged;
+};
+
+#define sAIBotRegistry AIBotRegistry::instance()
+
+#endif
@@ -0,0 +1,461 @@
+#include "AIBotSpawner.h"
+#include "AIBotRegistry.h"
+#include "AccountMgr.h"
+#include "CharacterCache.h"
+#include "Chat.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include "ObjectAccessor.h"
+#include "ObjectMgr.h"
+#include "Player.h"
+#include "QueryHolder.h"
+#include "SharedDefines.h"
+#include "StringConvert.h"
+#include "StringFormat.h"
+#include "Timer.h"
+#include "Tokenize.h"
+#include "WorldSession.h"
+#include "WorldSessionMgr.h"
+
+// WICHTIG: Zuerst MySQLConnection, dann CharacterDatabase
+#include "MySQLConnection.h"
+
+// Geht auch so
+#include "CharacterDatabase.h"
+
+using CharacterDatabasePreparedStatement = PreparedStatement<CharacterDatabaseConnection>;
+
+// --- Bot Login Helper (Nachbau von LoginQueryHolder aus CharacterHandler.cpp) ---
+// WICHTIG: Async-Holder wie im Core-Login, damit ASYNC PreparedStatements genutzt werden.
+//
+// Player::LoadFromDB kommt mit fehlenden Ergebnissen klar (keine Quests, keine
+// Aktionsleisten, ...). Die Profile lassen daher weg, was der AI-Loop nicht
+// braucht; Bots werden in OnPlayerLevelChanged ohnehin auf Level 1 zurückgesetzt.
+//
+// Nicht weglassen darf man Tabellen, die SaveToDB aus dem Speicher komplett neu
+// schreibt (Auren, Reputation, Glyphen) oder deren Zeilen beim Speichern per
+// Slot ersetzt werden (Inventar): sonst überschreibt der nächste Save die
+// gespeicherten Daten des Bots bzw. verwaist item_instance-Zeilen. Weggelassen
+// wird nur, was der Core nur bei Änderungen schreibt.
+namespace
+{
+    struct BotLoginQuery
+    {
+        CharacterDatabaseStatements statement;
+        PlayerLoginQueryIndex index;
+        uint8 profiles;         // Bitmaske über AIBotLoginProfile
+        bool fromTemplate;      // Im Template-Profil mit der GUID des Template-Charakters
+    };
+
+    constexpr uint8 ProfileMask(AIBotLoginProfile profile) { return uint8(1 << profile); }
+
+    constexpr uint8 AllProfiles = ProfileMask(AI_LOGIN_PROFILE_FULL) | ProfileMask(AI_LOGIN_PROFILE_COMBAT) | ProfileMask(AI_LOGIN_PROFILE_TEMPLATE);
+    constexpr uint8 FullOnly = ProfileMask(AI_LOGIN_PROFILE_FULL);
+
+    BotLoginQuery const BotLoginQueries[] =
+    {
+        { CHAR_SEL_CHARACTER,                     PLAYER_LOGIN_QUERY_LOAD_FROM,                   AllProfiles,    false },
+        { CHAR_SEL_CHARACTER_AURAS,               PLAYER_LOGIN_QUERY_LOAD_AURAS,                  AllProfiles,    false },
+        { CHAR_SEL_CHARACTER_SPELL,               PLAYER_LOGIN_QUERY_LOAD_SPELLS,                 AllProfiles,    true  },
+        { CHAR_SEL_CHARACTER_QUESTSTATUS,         PLAYER_LOGIN_QUERY_LOAD_QUEST_STATUS,           FullOnly,       false },
+        { CHAR_SEL_CHARACTER_DAILYQUESTSTATUS,    PLAYER_LOGIN_QUERY_LOAD_DAILY_QUEST_STATUS,     FullOnly,       false },
+        { CHAR_SEL_CHARACTER_WEEKLYQUESTSTATUS,   PLAYER_LOGIN_QUERY_LOAD_WEEKLY_QUEST_STATUS,    FullOnly,       false },
+        { CHAR_SEL_CHARACTER_MONTHLYQUESTSTATUS,  PLAYER_LOGIN_QUERY_LOAD_MONTHLY_QUEST_STATUS,   FullOnly,       false },
+        { CHAR_SEL_CHARACTER_SEASONALQUESTSTATUS, PLAYER_LOGIN_QUERY_LOAD_SEASONAL_QUEST_STATUS,  FullOnly,       false },
+        { CHAR_SEL_CHARACTER_REPUTATION,          PLAYER_LOGIN_QUERY_LOAD_REPUTATION,             AllProfiles,    false },
+        // Items haben eigene GUIDs, die nie von einem Template kommen dürfen
+        { CHAR_SEL_CHARACTER_INVENTORY,           PLAYER_LOGIN_QUERY_LOAD_INVENTORY,              AllProfiles,    false },
+        { CHAR_SEL_CHARACTER_ACTIONS,             PLAYER_LOGIN_QUERY_LOAD_ACTIONS,                FullOnly,       false },
+        // Skills nie vom Template: Level-Reset und Skill-Ups markieren sie als geändert
+        { CHAR_SEL_CHARACTER_SKILLS,              PLAYER_LOGIN_QUERY_LOAD_SKILLS,                 AllProfiles,    false },
+        { CHAR_SEL_CHARACTER_EQUIPMENTSETS,       PLAYER_LOGIN_QUERY_LOAD_EQUIPMENT_SETS,         FullOnly,       false },
+        { CHAR_SEL_CHARACTER_GLYPHS,              PLAYER_LOGIN_QUERY_LOAD_GLYPHS,                 AllProfiles,    false },
+        { CHAR_SEL_CHARACTER_TALENTS,             PLAYER_LOGIN_QUERY_LOAD_TALENTS,                AllProfiles,    true  },
+        // Ohne Homebind legt der Core beim Login einen neuen an (DB-Write), daher immer laden
+        { CHAR_SEL_CHARACTER_HOMEBIND,            PLAYER_LOGIN_QUERY_LOAD_HOME_BIND,              AllProfiles,    false }
+    };
+}
+
+class BotLoginQueryHolder : public CharacterDatabaseQueryHolder {
+private:
+    uint32 m_accountId;
+    ObjectGuid m_guid;
+    AIBotLoginProfile m_profile;
+    ObjectGuid m_templateGuid;
+    uint32 m_queryCount;
+public:
+    BotLoginQueryHolder(uint32 accountId, ObjectGuid guid, AIBotLoginProfile profile, ObjectGuid templateGuid)
+        : m_accountId(accountId), m_guid(guid), m_profile(profile), m_templateGuid(templateGuid), m_queryCount(0) {
+        // Ohne Template-Charakter für die Klasse bleibt nur das Combat-Profil
+        if (m_profile == AI_LOGIN_PROFILE_TEMPLATE && !m_templateGuid)
+            m_profile = AI_LOGIN_PROFILE_COMBAT;
+    }
+
+    // Gibt die GUID zurück (wichtig für HandlePlayerLoginFromDB)
+    ObjectGuid GetGuid() const { return m_guid; }
+    AIBotLoginProfile GetProfile() const { return m_profile; }
+    uint32 GetQueryCount() const { return m_queryCount; }
+
+    bool Initialize() {
+        SetSize(MAX_PLAYER_LOGIN_QUERY);
+
+        bool res = true;
+        ObjectGuid::LowType lowGuid = m_guid.GetCounter();
+        ObjectGuid::LowType templateGuid = m_templateGuid.GetCounter();
+
+        for (BotLoginQuery const& query : BotLoginQueries) {
+            if (!(query.profiles & ProfileMask(m_profile)))
+                continue;
+
+            bool useTemplate = query.fromTemplate && m_profile == AI_LOGIN_PROFILE_TEMPLATE;
+            CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(query.statement);
+            stmt->SetData(0, useTemplate ? templateGuid : lowGuid);
+            res &= SetPreparedQuery(query.index, stmt);
+            ++m_queryCount;
+        }
+
+        return res;
+    }
+};
+
+AIBotSpawner::AIBotSpawner() : _roster({ "Bota", "Botb", "Botc", "Botd", "Bote" }), _maxPendingLoads(50), _maxFinalizePerTick(5),
+    _loginProfile(AI_LOGIN_PROFILE_FULL),
+    _batchRequested(0), _batchSpawned(0), _batchFailed(0), _batchLatencySum(0), _batchLatencyMax(0), _pendingRangeQueries(0)
+{
+}
+
+AIBotSpawner* AIBotSpawner::instance()
+{
+    static AIBotSpawner instance;
+    return &instance;
+}
+
+void AIBotSpawner::Enqueue(std::string const& name, ObjectGuid requester)
+{
+    Request request;
+    request.name = name;
+    EnqueueRequest(std::move(request));
+
+    if (requester && std::find(_requesters.begin(), _requesters.end(), requester) == _requesters.end())
+        _requesters.push_back(requester);
+}
+
+void AIBotSpawner::Enqueue(ObjectGuid guid, ObjectGuid requester)
+{
+    Request request;
+    request.guid = guid;
+    EnqueueRequest(std::move(request));
+
+    if (requester && std::find(_requesters.begin(), _requesters.end(), requester) == _requesters.end())
+        _requesters.push_back(requester);
+}
+
+void AIBotSpawner::EnqueueRoster(ObjectGuid requester)
+{
+    for (std::string const& name : _roster)
+        Enqueue(name, requester);
+}
+
+void AIBotSpawner::EnqueueAccountRange(uint32 firstAccount, uint32 lastAccount, ObjectGuid requester)
+{
+    if (firstAccount > lastAccount)
+        std::swap(firstAccount, lastAccount);
+
+    if (requester && std::find(_requesters.begin(), _requesters.end(), requester) == _requesters.end())
+        _requesters.push_back(requester);
+
+    // Nur Zahlen im Statement, kein Escaping nötig
+    ++_pendingRangeQueries;
+    _queryCallbacks.AddCallback(CharacterDatabase.AsyncQuery(Acore::StringFormat(
+        "SELECT MIN(guid) FROM characters WHERE account BETWEEN {} AND {} GROUP BY account", firstAccount, lastAccount))
+        .WithCallback([this, firstAccount, lastAccount](QueryResult result)
+        {
+            --_pendingRangeQueries;
+            if (!result)
+            {
+                LOG_ERROR("module", "AI-SPAWN: Keine Charaktere auf den Accounts {}-{}.", firstAccount, lastAccount);
+                ReportIfDone();
+                return;
+            }
+
+            do
+            {
+                Enqueue(ObjectGuid::Create<HighGuid::Player>((*result)[0].Get<uint32>()));
+            } while (result->NextRow());
+        }));
+}
+
+void AIBotSpawner::EnqueueRequest(Request&& request)
+{
+    request.queuedTime = getMSTime();
+    ++_batchRequested;
+    _waiting.push_back(std::move(request));
+}
+
+void AIBotSpawner::Update()
+{
+    _queryCallbacks.ProcessReadyCallbacks();
+
+    // Fertige DB-Loads wandern nur in die _loaded-Queue, das ist billig
+    _holderCallbacks.ProcessReadyCallbacks();
+
+    StartLoads();
+    FinalizeLoaded();
+    ReportIfDone();
+}
+
+void AIBotSpawner::StartLoads()
+{
+    while (!_waiting.empty() && _loading.size() < _maxPendingLoads)
+    {
+        Request request = std::move(_waiting.front());
+        _waiting.pop_front();
+
+        if (!StartLoad(request))
+            continue;
+
+        uint32 accountId = request.accountId;
+        std::shared_ptr<BotLoginQueryHolder> holder = request.holder;
+        _loading.emplace(accountId, std::move(request));
+
+        _holderCallbacks.AddCallback(CharacterDatabase.DelayQueryHolder(holder)).AfterComplete(
+            [this, accountId](SQLQueryHolderBase const& /*holder*/)
+            {
+                auto itr = _loading.find(accountId);
+                if (itr == _loading.end())
+                    return;
+
+                itr->second.loadTime = getMSTimeDiff(itr->second.loadStartTime, getMSTime());
+                _loaded.push_back(std::move(itr->second));
+                _loading.erase(itr);
+            });
+    }
+}
+
+bool AIBotSpawner::StartLoad(Request& request)
+{
+    if (!request.guid)
+    {
+        if (request.name.empty())
+        {
+            Fail(request, "Bot-Name fehlt");
+            return false;
+        }
+
+        request.guid = sCharacterCache->GetCharacterGuidByName(request.name);
+        if (!request.guid)
+        {
+            Fail(request, "Charakter nicht gefunden");
+            return false;
+        }
+    }
+    else if (request.name.empty())
+    {
+        if (CharacterCacheEntry const* entry = sCharacterCache->GetCharacterCacheByGuid(request.guid))
+            request.name = entry->Name;
+    }
+
+    if (ObjectAccessor::FindConnectedPlayer(request.guid))
+    {
+        Fail(request, "Bot ist bereits online");
+        return false;
+    }
+
+    request.accountId = sCharacterCache->GetCharacterAccountIdByGuid(request.guid);
+    if (request.accountId == 0)
+    {
+        Fail(request, "Ungültige AccountID");
+        return false;
+    }
+
+    if (sWorldSessionMgr->FindSession(request.accountId))
+    {
+        Fail(request, "Account bereits eingeloggt");
+        return false;
+    }
+
+    if (sAIBotRegistry->FindByAccount(request.accountId) || _loading.count(request.accountId))
+    {
+        Fail(request, "Bot bereits aktiv");
+        return false;
+    }
+
+    // Session ohne Socket, wie im Core-Login-Flow
+    WorldSession* botSession = new WorldSession(
+        request.accountId,
+        std::string(request.name),
+        0,      // Security Token (dummy)
+        nullptr,// Socket (dummy)
+        SEC_PLAYER,
+        EXPANSION_WRATH_OF_THE_LICH_KING,
+        time_t(0),
+        LOCALE_enUS,
+        0,
+        false,
+        true,   // skipQueue = true
+        0
+    );
+
+    request.holder = std::make_shared<BotLoginQueryHolder>(request.accountId, request.guid, _loginProfile, GetTemplateGuid(request.guid));
+    if (!request.holder->Initialize())
+    {
+        delete botSession;
+        Fail(request, "Interner DB-Fehler (Init)");
+        return false;
+    }
+
+    sAIBotRegistry->Register(request.accountId, request.guid, request.name, botSession);
+    request.queryCount = request.holder->GetQueryCount();
+    request.loadStartTime = getMSTime();
+    return true;
+}
+
+void AIBotSpawner::SetTemplates(std::string const& templates)
+{
+    // "klasse:Name,klasse:Name"
+    _templates.clear();
+    for (std::string_view entry : Acore::Tokenize(templates, ',', false))
+    {
+        std::size_t colon = entry.find(':');
+        if (colon == std::string_view::npos)
+            continue;
+
+        Optional<uint8> classId = Acore::StringTo<uint8>(entry.substr(0, colon));
+        std::string_view name = TrimSpaces(entry.substr(colon + 1));
+        if (!classId || *classId >= MAX_CLASSES || name.empty())
+        {
+            LOG_ERROR("module", "AI-SPAWN: Ungültiges Login-Template '{}'.", entry);
+            continue;
+        }
+
+        _templates[*classId] = std::string(name);
+    }
+}
+
+ObjectGuid AIBotSpawner::GetTemplateGuid(ObjectGuid bot) const
+{
+    if (_loginProfile != AI_LOGIN_PROFILE_TEMPLATE)
+        return ObjectGuid::Empty;
+
+    CharacterCacheEntry const* entry = sCharacterCache->GetCharacterCacheByGuid(bot);
+    if (!entry)
+        return ObjectGuid::Empty;
+
+    auto itr = _templates.find(entry->Class);
+    if (itr == _templates.end())
+        return ObjectGuid::Empty;
+
+    return sCharacterCache->GetCharacterGuidByName(itr->second);
+}
+
+void AIBotSpawner::FinalizeLoaded()
+{
+    // AddPlayerToMap & Co. sind teuer, daher begrenzt pro Tick
+    for (uint32 i = 0; i < _maxFinalizePerTick && !_loaded.empty(); ++i)
+    {
+        Request request = std::move(_loaded.front());
+        _loaded.pop_front();
+
+        if (!Finalize(request))
+            continue;
+
+        uint32 latency = getMSTimeDiff(request.queuedTime, getMSTime());
+        ++_batchSpawned;
+        _batchLatencySum += latency;
+        _batchLatencyMax = std::max(_batchLatencyMax, latency);
+
+        LOG_INFO("module", "AI-SPAWN: Bot '{}' online nach {} ms (DB {} ms, {} Queries), {}/{}.", request.name, latency,
+            request.loadTime, request.queryCount, _batchSpawned + _batchFailed, _batchRequested);
+    }
+}
+
+bool AIBotSpawner::Finalize(Request& request)
+{
+    AIBotEntry* bot = sAIBotRegistry->FindByAccount(request.accountId);
+    if (!bot)
+    {
+        Fail(request, "Session nicht gefunden");
+        return false;
+    }
+
+    WorldSession* session = bot->session;
+    Player* botPlayer = new Player(session);
+
+    if (!botPlayer->LoadFromDB(request.guid, *request.holder))
+    {
+        delete botPlayer;
+        sAIBotRegistry->Remove(request.accountId);
+        Fail(request, "Player konnte nicht geladen werden");
+        return false;
+    }
+
+    // Holder wird nicht mehr gebraucht
+    request.holder.reset();
+
+    session->SetPlayer(botPlayer);
+
+    botPlayer->GetMotionMaster()->Initialize();
+    botPlayer->SendInitialPacketsBeforeAddToMap();
+
+    ObjectAccessor::AddObject(botPlayer);
+    sAIBotRegistry->BindPlayer(*bot, botPlayer);
+
+    if (!botPlayer->GetMap()->AddPlayerToMap(botPlayer) || !botPlayer->CheckInstanceLoginValid())
+    {
+        AreaTriggerTeleport const* at = sObjectMgr->GetGoBackTrigger(botPlayer->GetMapId());
+        if (at)
+        {
+            botPlayer->TeleportTo(at->target_mapId, at->target_X, at->target_Y, at->target_Z, botPlayer->GetOrientation());
+        }
+        else
+        {
+            botPlayer->TeleportTo(botPlayer->m_homebindMapId, botPlayer->m_homebindX, botPlayer->m_homebindY, botPlayer->m_homebindZ, botPlayer->GetOrientation());
+        }
+
+        botPlayer->GetSession()->SendNameQueryOpcode(botPlayer->GetGUID());
+    }
+
+    botPlayer->SendInitialPacketsAfterAddToMap();
+
+    CharacterDatabasePreparedStatement* onlineStmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_CHAR_ONLINE);
+    onlineStmt->SetData(0, botPlayer->GetGUID().GetCounter());
+    CharacterDatabase.Execute(onlineStmt);
+
+    constexpr uint32 kSpawnMapId = 0;
+    constexpr float kSpawnX = -8921.037f;
+    constexpr float kSpawnY = -120.484985f;
+    constexpr float kSpawnZ = 82.02542f;
+    constexpr float kSpawnO = 3.299f;
+
+    botPlayer->TeleportTo(kSpawnMapId, kSpawnX, kSpawnY, kSpawnZ, kSpawnO);
+    request.name = botPlayer->GetName();
+    return true;
+}
+
+void AIBotSpawner::Fail(Request const& request, char const* reason)
+{
+    ++_batchFailed;
+    LOG_ERROR("module", "AI-SPAWN: Bot '{}' ({}) nicht gespawnt: {}.", request.name, request.guid.ToString(), reason);
+}
+
+void AIBotSpawner::ReportIfDone()
+{
+    if (!_batchRequested || !IsIdle() || _pendingRangeQueries)
+        return;
+
+    uint32 average = _batchSpawned ? uint32(_batchLatencySum / _batchSpawned) : 0;
+    std::string summary = Acore::StringFormat("AI-SPAWN: {} von {} Bots online, {} fehlgeschlagen, Latenz Ø {} ms, max {} ms.",
+        _batchSpawned, _batchRequested, _batchFailed, average, _batchLatencyMax);
+    LOG_INFO("module", "{}", summary);
+
+    for (ObjectGuid const& requester : _requesters)
+        if (Player* player = ObjectAccessor::FindConnectedPlayer(requester))
+            ChatHandler(player->GetSession()).SendSysMessage(summary);
+
+    _requesters.clear();
+    _batchRequested = 0;
+    _batchSpawned = 0;
+    _batchFailed = 0;
+    _batchLatencySum = 0;
+    _batchLatencyMax = 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Bulk-Spawn von Bots.
+ *
+ * Eine Pipeline im World-Thread: Anfragen warten in einer Queue, höchstens
+ * MaxPendingLoads Logins laden gleichzeitig ihre Daten asynchron aus der DB,
+ * und pro Tick werden höchstens MaxFinalizePerTick geladene Bots in die Welt
+ * gesetzt. So blockieren 500 gleichzeitig fertige Logins nicht einen Tick.
+ */
+
+#ifndef MOD_AI_CONTROLLER_BOT_SPAWNER_H
+#define MOD_AI_CONTROLLER_BOT_SPAWNER_H
+
+#include "AsyncCallbackProcessor.h"
+#include "DatabaseEnvFwd.h"
+#include "Define.h"
+#include "ObjectGuid.h"
+#include "QueryCallback.h"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Welche Charakterdaten beim Bot-Login geladen werden
+enum AIBotLoginProfile : uint8
+{
+    AI_LOGIN_PROFILE_FULL,      // Wie ein echter Login (alle Queries des Holders)
+    AI_LOGIN_PROFILE_COMBAT,    // Ohne Quests, Aktionsleisten und Ausrüstungssets
+    AI_LOGIN_PROFILE_TEMPLATE,  // Wie Combat, Spells/Talente vom Template-Charakter der Klasse
+    MAX_AI_LOGIN_PROFILE
+};
+
+class BotLoginQueryHolder;
+class SQLQueryHolderCallback;
+class WorldSession;
+
+class AIBotSpawner
+{
+public:
+    static AIBotSpawner* instance();
+
+    // Nur World-Thread. requester bekommt am Ende eine Zusammenfassung im Chat.
+    void Enqueue(std::string const& name, ObjectGuid requester = ObjectGuid::Empty);
+    void Enqueue(ObjectGuid guid, ObjectGuid requester = ObjectGuid::Empty);
+
+    // Je Account der erste Charakter, per asynchroner Query
+    void EnqueueAccountRange(uint32 firstAccount, uint32 lastAccount, ObjectGuid requester = ObjectGuid::Empty);
+
+    // AIController.Spawn.Roster
+    void EnqueueRoster(ObjectGuid requester = ObjectGuid::Empty);
+
+    // Jeden World-Tick
+    void Update();
+
+    void SetRoster(std::vector<std::string> roster) { _roster = std::move(roster); }
+    void SetMaxPendingLoads(uint32 count) { _maxPendingLoads = std::max<uint32>(count, 1); }
+    void SetMaxFinalizePerTick(uint32 count) { _maxFinalizePerTick = std::max<uint32>(count, 1); }
+    void SetLoginProfile(AIBotLoginProfile profile) { _loginProfile = profile; }
+
+    // AIController.Login.Templates: "klasse:Name,..." (z.B. "5:Tplpriest,1:Tplwarrior")
+    void SetTemplates(std::string const& templates);
+
+    bool IsIdle() const { return _waiting.empty() && _loading.empty() && _loaded.empty(); }
+
+private:
+    AIBotSpawner();
+
+    struct Request
+    {
+        std::string name;
+        ObjectGuid guid;
+        uint32 accountId = 0;
+        uint32 queuedTime = 0;      // getMSTime() beim Einreihen
+        uint32 loadStartTime = 0;   // getMSTime() beim Start der DB-Queries
+        uint32 loadTime = 0;        // Dauer der DB-Queries in ms
+        uint32 queryCount = 0;      // Anzahl der Login-Queries laut Profil
+        std::shared_ptr<BotLoginQueryHolder> holder;
+    };
+
+    void EnqueueRequest(Request&& request);
+    void StartLoads();
+    bool StartLoad(Request& request);
+    void FinalizeLoaded();
+    bool Finalize(Request& request);
+    void Fail(Request const& request, char const* reason);
+    ObjectGuid GetTemplateGuid(ObjectGuid bot) const;
+    void ReportIfDone();
+
+    std::vector<std::string> _roster;
+    uint32 _maxPendingLoads;
+    uint32 _maxFinalizePerTick;
+    AIBotLoginProfile _loginProfile;
+    std::unordered_map<uint8, std::string> _templates;     // Klasse -> Name des Template-Charakters
+
+    std::deque<Request> _waiting;
+    std::unordered_map<uint32, Request> _loading;   // Key = AccountId
+    std::deque<Request> _loaded;
+
+    AsyncCallbackProcessor<SQLQueryHolderCallback> _holderCallbacks;
+    QueryCallbackProcessor _queryCallbacks;
+
+    // Fortschritt des laufenden Batches, wird nach der Zusammenfassung zurückgesetzt
+    std::vector<ObjectGuid> _requesters;
+    uint32 _batchRequested;
+    uint32 _batchSpawned;
+    uint32 _batchFailed;
+    uint64 _batchLatencySum;
+    uint32 _batchLatencyMax;
+    uint32 _pendingRangeQueries;
+};
+
+#define sAIBotSpawner AIBotSpawner::instance()
+
+#endif
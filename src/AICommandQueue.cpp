@@ -0,0 +1,101 @@
+#include "AICommandQueue.h"
+#include "AIController.h"
+
+struct AICommandQueue::Node
+{
+    AICommand command;
+    Node* next = nullptr;
+};
+
+AICommandQueue::AICommandQueue(uint32 capacity) : _head(nullptr), _size(0), _capacity(capacity), _dropped(0)
+{
+}
+
+AICommandQueue::~AICommandQueue()
+{
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    while (node)
+    {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+bool AICommandQueue::Push(AICommand&& command)
+{
+    // Platz reservieren, bevor der Knoten sichtbar wird
+    if (_size.fetch_add(1, std::memory_order_relaxed) >= _capacity.load(std::memory_order_relaxed))
+    {
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Node* node = new Node{ std::move(command) };
+    node->next = _head.load(std::memory_order_relaxed);
+    while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    return true;
+}
+
+bool AICommandQueue::PushBatch(std::vector<AICommand>&& commands)
+{
+    uint32 count = uint32(commands.size());
+    if (!count)
+        return true;
+
+    if (_size.fetch_add(count, std::memory_order_relaxed) + count > _capacity.load(std::memory_order_relaxed))
+    {
+        _size.fetch_sub(count, std::memory_order_relaxed);
+        _dropped.fetch_add(count, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Kette rückwärts verlinken wie bei einzelnen Pushes: first ist das letzte Kommando
+    Node* first = nullptr;
+    Node* last = nullptr;
+    for (AICommand& command : commands)
+    {
+        Node* node = new Node{ std::move(command) };
+        node->next = first;
+        first = node;
+        if (!last)
+            last = node;
+    }
+
+    last->next = _head.load(std::memory_order_relaxed);
+    while (!_head.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    return true;
+}
+
+void AICommandQueue::TakeAll(std::vector<AICommand>& out)
+{
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    if (!node)
+        return;
+
+    // Die Liste ist LIFO, zum Abarbeiten umdrehen
+    Node* reversed = nullptr;
+    uint32 count = 0;
+    while (node)
+    {
+        Node* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+        ++count;
+    }
+
+    out.reserve(out.size() + count);
+    while (reversed)
+    {
+        Node* next = reversed->next;
+        out.push_back(std::move(reversed->command));
+        delete reversed;
+        reversed = next;
+    }
+
+    _size.fetch_sub(count, std::memory_order_relaxed);
+}
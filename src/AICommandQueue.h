@@ -0,0 +1,52 @@
+/*
+ * Lock-freie Command-Queue zwischen Netzwerk-Threads und World-Thread.
+ *
+ * Mehrere Produzenten hängen per CAS an eine einfach verkettete Liste an, der
+ * World-Thread übernimmt mit einem einzigen exchange() alle wartenden
+ * Kommandos auf einmal. Da nie einzelne Knoten entnommen werden, gibt es kein
+ * ABA-Problem. Die Größe ist begrenzt; ist die Queue voll, wird verworfen.
+ */
+
+#ifndef MOD_AI_CONTROLLER_COMMAND_QUEUE_H
+#define MOD_AI_CONTROLLER_COMMAND_QUEUE_H
+
+#include "Define.h"
+#include <atomic>
+#include <vector>
+
+struct AICommand;
+
+class AICommandQueue
+{
+public:
+    explicit AICommandQueue(uint32 capacity);
+    ~AICommandQueue();
+
+    AICommandQueue(AICommandQueue const&) = delete;
+    AICommandQueue& operator=(AICommandQueue const&) = delete;
+
+    // Beliebiger Thread. false, wenn die Queue voll ist.
+    bool Push(AICommand&& command);
+
+    // Alle oder keins, mit einem einzigen CAS: TakeAll sieht den Batch nie halb
+    bool PushBatch(std::vector<AICommand>&& commands);
+
+    // Nur World-Thread: hängt alle wartenden Kommandos in FIFO-Reihenfolge an out an
+    void TakeAll(std::vector<AICommand>& out);
+
+    void SetCapacity(uint32 capacity) { _capacity.store(capacity, std::memory_order_relaxed); }
+    uint32 GetSize() const { return _size.load(std::memory_order_relaxed); }
+
+    // Seit dem letzten Aufruf wegen voller Queue verworfene Kommandos
+    uint32 ConsumeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    struct Node;
+
+    std::atomic<Node*> _head;
+    std::atomic<uint32> _size;
+    std::atomic<uint32> _capacity;
+    std::atomic<uint32> _dropped;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Gemeinsame Deklarationen für mod-ai-controller.
+ * Wird vom World-Hook (AIControllerHook.cpp) und vom Socket-Server
+ * (AIControllerServer.cpp) benutzt.
+ */
+
+#ifndef MOD_AI_CONTROLLER_H
+#define MOD_AI_CONTROLLER_H
+
+#include "AICommandQueue.h"
+#include "AIProtocol.h"
+#include "AIState.h"
+#include "Define.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Wird bereits im Netzwerk-Thread fertig geparst, der World-Thread sieht nur typisierte Werte
+struct AICommand {
+    std::string playerName;     // Text-Protokoll
+    uint64 playerGuid = 0;      // Binär-Protokoll
+    uint32 botHandle = AI_INVALID_BOT_HANDLE;  // Roster-Handle ("#n" bzw. AI_FRAME_BOT_COMMAND)
+    AIAction action = AI_ACTION_NONE;
+
+    float x = 0.0f, y = 0.0f, z = 0.0f;    // move_to
+    float range = 0.0f;                     // target_nearest, loot_all, vendor_run (0 = Default)
+    uint32 spellId = 0;                     // cast
+    uint64 targetGuid = 0;                  // target_guid, loot_guid, sell_grey, attack
+    std::string text;                       // say
+    uint64 episodeId = 0;                   // reset, reset_batch (0 = kein Episode-Event)
+    std::vector<uint32> botHandles;         // reset_batch (leer = alle Bots)
+
+    // Absender (Step-, Episode- und Makro-Events); AI_ACTION_NONE mit stepId markiert das Ende eines Steps
+    uint32 sessionId = 0;
+    uint64 stepId = 0;
+
+    // Nur mit AIController.Metrics.Enable gesetzt, für AI_HIST_COMMAND_LATENCY
+    std::chrono::steady_clock::time_point receivedAt;
+};
+
+// Schützt nur den Pointer-Tausch, nie Weltlogik
+extern std::mutex g_StateMutex;
+extern AIStateSnapshotPtr g_CurrentState;
+
+// Netzwerk-Threads -> World-Thread, ohne Lock
+extern AICommandQueue g_CommandQueue;
+
+// Wird von OnUpdate nach jedem neuen Snapshot inkrementiert
+extern std::atomic<uint64_t> g_StateVersion;
+
+#endif
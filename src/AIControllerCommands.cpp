@@ -0,0 +1,59 @@
+/*
+ * GM-Befehle des Moduls.
+ *
+ * .aicontroller stats [reset|on|off]
+ *   Zeigt die Metriken aus AIMetrics (Tick-Anteile, Kommando-Latenz, Queue,
+ *   Traffic pro Client). Läuft auch auf der Konsole.
+ */
+
+#include "AIControllerServer.h"
+#include "AIMetrics.h"
+#include "Chat.h"
+#include "CommandScript.h"
+#include "Tokenize.h"
+
+using namespace Acore::ChatCommands;
+
+class AIControllerCommandScript : public CommandScript {
+public:
+    AIControllerCommandScript() : CommandScript("AIControllerCommandScript") {}
+
+    ChatCommandTable GetCommands() const override {
+        static ChatCommandTable aiControllerTable = {
+            { "stats", HandleStatsCommand, SEC_GAMEMASTER, Console::Yes }
+        };
+        static ChatCommandTable commandTable = {
+            { "aicontroller", aiControllerTable }
+        };
+        return commandTable;
+    }
+
+    static bool HandleStatsCommand(ChatHandler* handler, Optional<std::string> option) {
+        if (option) {
+            if (*option == "reset") {
+                sAIMetrics->Reset();
+                handler->SendSysMessage("AI-Controller: Metriken zurückgesetzt.");
+                return true;
+            }
+            if (*option == "on" || *option == "off") {
+                sAIMetrics->SetEnabled(*option == "on");
+                handler->PSendSysMessage("AI-Controller: Metriken {}.", *option == "on" ? "aktiviert" : "deaktiviert");
+                return true;
+            }
+            handler->SendSysMessage("Verwendung: .aicontroller stats [reset|on|off]");
+            return false;
+        }
+
+        if (!sAIMetrics->IsEnabled())
+            handler->SendSysMessage("AI-Controller: Metriken sind aus (AIController.Metrics.Enable), Werte sind vom letzten Lauf.");
+
+        std::string report = sAIServer->BuildMetricsReport();
+        for (std::string_view line : Acore::Tokenize(report, '\n', false))
+            handler->SendSysMessage(line);
+        return true;
+    }
+};
+
+void AddAIControllerCommandScripts() {
+    new AIControllerCommandScript();
+}
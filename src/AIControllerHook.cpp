@@ -1,6 +1,17 @@
+#include "AIBotRegistry.h"
+#include "AIBotSpawner.h"
+#include "AIController.h"
+#include "AIControllerServer.h"
+#include "AIItemScore.h"
+#include "AIMacro.h"
+#include "AIMetrics.h"
+#include "AIObservation.h"
+#include "AIPerception.h"
+#include "AITrajectory.h"
 #include "ScriptMgr.h"
 #include "Player.h"
 #include "Config.h"
+#include "CharacterCache.h"
 #include "Chat.h"
 #include "Log.h"
 #include "World.h"
@@ -8,17 +19,17 @@
 #include "WorldSessionMgr.h"
 #include "WorldSocket.h" 
 #include "ObjectAccessor.h"
+#include <array>
 #include <cmath>
-#include <boost/asio.hpp>
-#include <thread>
 #include <mutex>
 #include <shared_mutex>
 #include <vector>
 #include <string>
 #include <queue>
-#include <sstream>
 #include <unordered_map>
 #include "GameTime.h" 
+#include "MotionMaster.h"
+#include "Timer.h"
 #include <atomic>
 #include "GridNotifiers.h"
 #include "GridNotifiersImpl.h"
@@ -27,479 +38,348 @@
 #include "Item.h"   
 #include "ItemTemplate.h"
 #include "Bag.h"
-#include "AccountMgr.h"
-#include "DatabaseEnv.h"
-#include "PreparedStatement.h"
-#include "QueryHolder.h"
-#include "DatabaseWorkerPool.h"
-#include "AsyncCallbackProcessor.h"
 #include "ObjectMgr.h"
+#include "Tokenize.h"
+#include <cstdio>
+#include <string_view>
 
-// WICHTIG: Zuerst MySQLConnection, dann CharacterDatabase
-#include "MySQLConnection.h"
-
-// Geht auch so
-#include "CharacterDatabase.h"
-
-using boost::asio::ip::tcp;
-using CharacterDatabasePreparedStatement = PreparedStatement<CharacterDatabaseConnection>;
-
-// HINWEIS: enum PlayerLoginQueryIndex wurde entfernt, da es bereits in Player.h definiert ist.
-
-// --- Bot Login Helper (Nachbau von LoginQueryHolder aus CharacterHandler.cpp) ---
-// WICHTIG: Async-Holder wie im Core-Login, damit ASYNC PreparedStatements genutzt werden.
-class BotLoginQueryHolder : public CharacterDatabaseQueryHolder {
-private:
-    uint32 m_accountId;
-    ObjectGuid m_guid;
-public:
-    BotLoginQueryHolder(uint32 accountId, ObjectGuid guid)
-        : m_accountId(accountId), m_guid(guid) {
-    }
-
-    // Gibt die GUID zurück (wichtig für HandlePlayerLoginFromDB)
-    ObjectGuid GetGuid() const { return m_guid; }
-
-    bool Initialize() {
-        SetSize(MAX_PLAYER_LOGIN_QUERY);
-
-        bool res = true;
-        ObjectGuid::LowType lowGuid = m_guid.GetCounter();
-
-        CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_FROM, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_AURAS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_AURAS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_SPELL);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_SPELLS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_QUESTSTATUS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_QUEST_STATUS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_DAILYQUESTSTATUS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_DAILY_QUEST_STATUS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_WEEKLYQUESTSTATUS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_WEEKLY_QUEST_STATUS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_MONTHLYQUESTSTATUS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_MONTHLY_QUEST_STATUS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_SEASONALQUESTSTATUS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_SEASONAL_QUEST_STATUS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_REPUTATION);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_REPUTATION, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_INVENTORY);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_INVENTORY, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_ACTIONS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_ACTIONS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_SKILLS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_SKILLS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_EQUIPMENTSETS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_EQUIPMENT_SETS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_GLYPHS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_GLYPHS, stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_TALENTS);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_TALENTS, stmt);
-
-        // Weitere (weniger kritisch, aber gut für Vollständigkeit):
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_HOMEBIND);
-        stmt->SetData(0, lowGuid);
-        res &= SetPreparedQuery(PLAYER_LOGIN_QUERY_LOAD_HOME_BIND, stmt);
-        // LoadQuery(CHAR_SEL_CHARACTER_SPELLCOOLDOWNS, PLAYER_LOGIN_QUERY_LOAD_SPELL_COOLDOWNS);
-
-        /*
-        if (sWorld->getBoolConfig(CONFIG_DECLINED_NAMES_USED))
-            LoadQuery(CHAR_SEL_CHARACTER_DECLINEDNAMES, PLAYER_LOGIN_QUERY_LOAD_DECLINED_NAMES);
-        */
-
-        // LoadQuery(CHAR_SEL_CHARACTER_ACHIEVEMENTS, PLAYER_LOGIN_QUERY_LOAD_ACHIEVEMENTS);
-        // LoadQuery(CHAR_SEL_CHARACTER_CRITERIAPROGRESS, PLAYER_LOGIN_QUERY_LOAD_CRITERIA_PROGRESS);
-        // LoadQuery(CHAR_SEL_CHARACTER_ENTRY_POINT, PLAYER_LOGIN_QUERY_LOAD_ENTRY_POINT);
-        // LoadQuery(CHAR_SEL_ACCOUNT_DATA, PLAYER_LOGIN_QUERY_LOAD_ACCOUNT_DATA);
-        // LoadQuery(CHAR_SEL_CHARACTER_RANDOMBG, PLAYER_LOGIN_QUERY_LOAD_RANDOM_BG);
-        // LoadQuery(CHAR_SEL_CHARACTER_BANNED, PLAYER_LOGIN_QUERY_LOAD_BANNED);
-        // LoadQuery(CHAR_SEL_CHARACTER_QUESTSTATUSREW, PLAYER_LOGIN_QUERY_LOAD_QUEST_STATUS_REW);
-        // LoadQuery(CHAR_SEL_BREW_OF_THE_MONTH, PLAYER_LOGIN_QUERY_LOAD_BREW_OF_THE_MONTH);
+std::mutex g_StateMutex;
+AIStateSnapshotPtr g_CurrentState = AIStateBuilder().Finish(0);
+std::atomic<uint64_t> g_StateVersion{ 0 };
+AICommandQueue g_CommandQueue(4096);
 
-        // LoadQuery(CHAR_SEL_CORPSE_LOCATION, PLAYER_LOGIN_QUERY_LOAD_CORPSE_LOCATION);
-        // LoadQuery(CHAR_SEL_CHAR_SETTINGS, PLAYER_LOGIN_QUERY_LOAD_CHARACTER_SETTINGS);
-        // LoadQuery(CHAR_SEL_CHAR_PETS, PLAYER_LOGIN_QUERY_LOAD_PET_SLOTS);
-        // LoadQuery(CHAR_SEL_CHAR_ACHIEVEMENT_OFFLINE_UPDATES, PLAYER_LOGIN_QUERY_LOAD_OFFLINE_ACHIEVEMENTS_UPDATES);
+// AIController.State.OnChange: Snapshot nur, wenn seit dem letzten etwas passiert ist.
+// Die Event-Hooks laufen teils in Map-Threads, daher atomar.
+std::atomic<bool> g_StateDirty{ true };
 
-        return res;
-    }
-};
-
-struct AICommand {
-    std::string playerName;
-    std::string actionType;
-    std::string value;
-};
+static void MarkStateDirty()
+{
+    g_StateDirty.store(true, std::memory_order_relaxed);
+}
 
-std::mutex g_Mutex;
-std::string g_CurrentJsonState = "{}";
-bool g_HasNewState = false;
-std::atomic<uint64_t> g_StateVersion{ 0 };
-std::queue<AICommand> g_CommandQueue;
+// --- INVENTORY ---
+// Eigene Item-Änderungen pflegt das Modul per OnSlotUpdated selbst. Die Item-Hooks
+// feuern dabei synchron im selben Thread und dürfen die Zusammenfassung nicht verwerfen.
+static thread_local bool t_ownItemChange = false;
 
-struct AIPlayerEvents
+struct AIOwnItemChange
 {
-    long long xp_gained = 0;
-    long long loot_copper = 0;
-    long long loot_score = 0;
-    bool leveled_up = false;
-    bool equipped_upgrade = false;
-
-    bool IsEmpty() const
-    {
-        return xp_gained == 0 && loot_copper == 0 && loot_score == 0 && !leveled_up && !equipped_upgrade;
-    }
+    AIOwnItemChange() { t_ownItemChange = true; }
+    ~AIOwnItemChange() { t_ownItemChange = false; }
 };
 
-std::mutex g_EventMutex;
-std::unordered_map<uint64, AIPlayerEvents> g_PlayerEvents;
-AsyncCallbackProcessor<SQLQueryHolderCallback> g_QueryHolderProcessor;
-std::unordered_map<uint32, WorldSession*> g_BotSessions;
-std::mutex g_BotSessionsMutex;
-
-// --- HELPER ---
-
-int GetItemScore(ItemTemplate const* proto) {
-    if (!proto) return 0;
-    int score = 0;
-    score += proto->Quality * 10;
-    score += proto->ItemLevel;
-    score += proto->Armor;
-    if (proto->Class == ITEM_CLASS_WEAPON) {
-        score += (int)(proto->Damage[0].DamageMax + proto->Damage[0].DamageMin);
-    }
-    for (int i = 0; i < proto->StatsCount; ++i) {
-        score += proto->ItemStat[i].ItemStatValue * 2;
-    }
-    return score;
-}
-
-static bool IsBotControlledPlayer(Player* p)
+static void MarkInventoryChanged(Player* player)
 {
-    if (!p)
-        return false;
-
-    WorldSession* sess = p->GetSession();
-    if (!sess)
-        return false;
-
-    std::lock_guard<std::mutex> lock(g_BotSessionsMutex);
-    for (auto const& it : g_BotSessions)
-        if (it.second == sess)
-            return true;
-
-    return false;
+    if (t_ownItemChange)
+        return;
+    if (AIInventorySummary* inventory = AIBotRegistry::GetInventory(player))
+        inventory->MarkDirty();
 }
 
-
-// --- PER-PLAYER EVENT HELPERS ---
-static inline uint64 AIEventKey(Player* player)
-{
-    return player ? player->GetGUID().GetRawValue() : 0ULL;
-}
+// --- PER-BOT EVENT HELPERS ---
+// Die Hooks feuern für jeden Player; Nicht-Bots haben kein Tag und kosten nur den CustomData-Lookup.
 
 static void AddXPGained(Player* player, uint32 amount)
 {
-    if (!player || amount == 0)
+    AIBotEvents* events = AIBotRegistry::GetEvents(player);
+    if (!events || amount == 0)
         return;
 
-    std::lock_guard<std::mutex> lock(g_EventMutex);
-    g_PlayerEvents[AIEventKey(player)].xp_gained += amount;
+    events->xpGained.fetch_add(amount, std::memory_order_relaxed);
+    MarkStateDirty();
 }
 
 static void AddLootCopper(Player* player, uint32 amount)
 {
-    if (!player || amount == 0)
+    AIBotEvents* events = AIBotRegistry::GetEvents(player);
+    if (!events || amount == 0)
         return;
 
-    std::lock_guard<std::mutex> lock(g_EventMutex);
-    g_PlayerEvents[AIEventKey(player)].loot_copper += amount;
+    events->lootCopper.fetch_add(amount, std::memory_order_relaxed);
+    MarkStateDirty();
 }
 
 static void AddLootScore(Player* player, uint32 amount)
 {
-    if (!player || amount == 0)
+    AIBotEvents* events = AIBotRegistry::GetEvents(player);
+    if (!events || amount == 0)
         return;
 
-    std::lock_guard<std::mutex> lock(g_EventMutex);
-    g_PlayerEvents[AIEventKey(player)].loot_score += amount;
+    events->lootScore.fetch_add(amount, std::memory_order_relaxed);
+    MarkStateDirty();
 }
 
 static void SetLeveledUp(Player* player)
 {
-    if (!player)
+    AIBotEvents* events = AIBotRegistry::GetEvents(player);
+    if (!events)
         return;
 
-    std::lock_guard<std::mutex> lock(g_EventMutex);
-    g_PlayerEvents[AIEventKey(player)].leveled_up = true;
+    events->flags.fetch_or(AI_PLAYER_FLAG_LEVELED_UP, std::memory_order_relaxed);
+    MarkStateDirty();
 }
 
 static void SetEquippedUpgrade(Player* player)
 {
-    if (!player)
+    AIBotEvents* events = AIBotRegistry::GetEvents(player);
+    if (!events)
         return;
 
-    std::lock_guard<std::mutex> lock(g_EventMutex);
-    g_PlayerEvents[AIEventKey(player)].equipped_upgrade = true;
+    events->flags.fetch_or(AI_PLAYER_FLAG_EQUIPPED_UPGRADE, std::memory_order_relaxed);
+    MarkStateDirty();
 }
 
-// Atomisch: Events für genau diesen Player holen und dabei resetten.
-static AIPlayerEvents ConsumePlayerEvents(Player* player)
-{
-    AIPlayerEvents out;
-    if (!player)
-        return out;
+// --- GEAR ---
 
-    uint64 key = AIEventKey(player);
-    std::lock_guard<std::mutex> lock(g_EventMutex);
+// Mögliche Slots eines Items; bei Paaren (Ringe, Schmuck, Einhand mit Beidhändigkeit) beide
+static uint8 GetEquipSlots(Player* player, ItemTemplate const* proto, std::array<uint8, 2>& slots) {
+    bool twoHandUsed = player->IsTwoHandUsed();
+    switch (proto->InventoryType) {
+    case INVTYPE_HEAD: slots[0] = EQUIPMENT_SLOT_HEAD; return 1;
+    case INVTYPE_NECK: slots[0] = EQUIPMENT_SLOT_NECK; return 1;
+    case INVTYPE_SHOULDERS: slots[0] = EQUIPMENT_SLOT_SHOULDERS; return 1;
+    case INVTYPE_BODY: slots[0] = EQUIPMENT_SLOT_BODY; return 1;
+    case INVTYPE_CHEST: case INVTYPE_ROBE: slots[0] = EQUIPMENT_SLOT_CHEST; return 1;
+    case INVTYPE_WAIST: slots[0] = EQUIPMENT_SLOT_WAIST; return 1;
+    case INVTYPE_LEGS: slots[0] = EQUIPMENT_SLOT_LEGS; return 1;
+    case INVTYPE_FEET: slots[0] = EQUIPMENT_SLOT_FEET; return 1;
+    case INVTYPE_WRISTS: slots[0] = EQUIPMENT_SLOT_WRISTS; return 1;
+    case INVTYPE_HANDS: slots[0] = EQUIPMENT_SLOT_HANDS; return 1;
+    case INVTYPE_CLOAK: slots[0] = EQUIPMENT_SLOT_BACK; return 1;
+    case INVTYPE_FINGER: slots[0] = EQUIPMENT_SLOT_FINGER1; slots[1] = EQUIPMENT_SLOT_FINGER2; return 2;
+    case INVTYPE_TRINKET: slots[0] = EQUIPMENT_SLOT_TRINKET1; slots[1] = EQUIPMENT_SLOT_TRINKET2; return 2;
+    case INVTYPE_WEAPON:
+        slots[0] = EQUIPMENT_SLOT_MAINHAND;
+        if (!player->CanDualWield() || twoHandUsed) return 1;
+        slots[1] = EQUIPMENT_SLOT_OFFHAND; return 2;
+    case INVTYPE_2HWEAPON: case INVTYPE_WEAPONMAINHAND: slots[0] = EQUIPMENT_SLOT_MAINHAND; return 1;
+    case INVTYPE_SHIELD: case INVTYPE_WEAPONOFFHAND: case INVTYPE_HOLDABLE:
+        // Neben einer Zweihandwaffe nur über deren Austausch
+        if (twoHandUsed) return 0;
+        slots[0] = EQUIPMENT_SLOT_OFFHAND; return 1;
+    case INVTYPE_RANGED: case INVTYPE_THROWN: case INVTYPE_RANGEDRIGHT: case INVTYPE_RELIC:
+        slots[0] = EQUIPMENT_SLOT_RANGED; return 1;
+    default: return 0;
+    }
+}
 
-    auto it = g_PlayerEvents.find(key);
-    if (it == g_PlayerEvents.end())
-        return out;
+// true, wenn das Item an srcPos angelegt wurde; an srcPos liegt danach das alte Item
+static bool TryEquipBest(Player* player, AIInventorySummary& inventory, uint16 srcPos) {
+    Item* item = player->GetItemByPos(srcPos);
+    if (!item || player->CanUseItem(item) != EQUIP_ERR_OK) return false;
 
-    out = it->second;
-    g_PlayerEvents.erase(it);
-    return out;
-}
+    ItemTemplate const* proto = item->GetTemplate();
+    std::array<uint8, 2> slots;
+    uint8 count = GetEquipSlots(player, proto, slots);
+    if (!count) return false;
 
-void TryEquipIfBetter(Player* player, uint16 srcPos) {
-    uint8 bag = srcPos >> 8;
-    uint8 slot = srcPos & 255;
-    Item* newItem = player->GetItemByPos(bag, slot);
-    if (!newItem) return;
-    if (player->CanUseItem(newItem) != EQUIP_ERR_OK) return;
+    // Bei Paaren den schwächeren Slot ersetzen (leer = -1)
+    uint8 slot = slots[0];
+    if (count == 2 && inventory.GetEquippedScore(player, slots[1]) < inventory.GetEquippedScore(player, slot)) slot = slots[1];
 
-    ItemTemplate const* proto = newItem->GetTemplate();
-    uint16 destSlot = 0xffff;
+    int32 newScore = GetItemScore(proto, player->getClass());
+    int32 currentScore = inventory.GetEquippedScore(player, slot);
 
-    switch (proto->InventoryType) {
-    case INVTYPE_HEAD: destSlot = EQUIPMENT_SLOT_HEAD; break;
-    case INVTYPE_SHOULDERS: destSlot = EQUIPMENT_SLOT_SHOULDERS; break;
-    case INVTYPE_BODY: case INVTYPE_CHEST: case INVTYPE_ROBE: destSlot = EQUIPMENT_SLOT_CHEST; break;
-    case INVTYPE_WAIST: destSlot = EQUIPMENT_SLOT_WAIST; break;
-    case INVTYPE_LEGS: destSlot = EQUIPMENT_SLOT_LEGS; break;
-    case INVTYPE_FEET: destSlot = EQUIPMENT_SLOT_FEET; break;
-    case INVTYPE_WRISTS: destSlot = EQUIPMENT_SLOT_WRISTS; break;
-    case INVTYPE_HANDS: destSlot = EQUIPMENT_SLOT_HANDS; break;
-    case INVTYPE_WEAPON: case INVTYPE_2HWEAPON: case INVTYPE_WEAPONMAINHAND: destSlot = EQUIPMENT_SLOT_MAINHAND; break;
-    case INVTYPE_SHIELD: case INVTYPE_WEAPONOFFHAND: destSlot = EQUIPMENT_SLOT_OFFHAND; break;
-    }
-
-    if (destSlot != 0xffff) {
-        int newScore = GetItemScore(proto);
-        int currentScore = -1;
-        Item* currentItem = player->GetItemByPos(INVENTORY_SLOT_BAG_0, destSlot);
-        if (currentItem) currentScore = GetItemScore(currentItem->GetTemplate());
-
-        if (newScore > currentScore) {
-            player->SwapItem(srcPos, destSlot);
-            player->PlayDistanceSound(120, player);
-            SetEquippedUpgrade(player);
-            LOG_INFO("module", "AI-GEAR: Upgrade angelegt! (Slot: {})", destSlot);
-        }
+    // Zweihänder verdrängt die Nebenhand: gegen Haupt- plus Nebenhand vergleichen
+    bool dropsOffhand = false;
+    if (proto->InventoryType == INVTYPE_2HWEAPON && !player->CanTitanGrip()) {
+        int32 offhand = inventory.GetEquippedScore(player, EQUIPMENT_SLOT_OFFHAND);
+        if (offhand >= 0) { currentScore = std::max(currentScore, 0) + offhand; dropsOffhand = true; }
+    }
+    if (newScore <= currentScore) return false;
+
+    // Prüft auch, ob die Nebenhand noch in die Taschen passt
+    uint16 destPos;
+    if (player->CanEquipItem(slot, destPos, item, true) != EQUIP_ERR_OK) return false;
+
+    bool wasEmpty = !player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot);
+    player->SwapItem(srcPos, destPos);
+    inventory.OnSlotUpdated(player, srcPos, false);
+    inventory.OnSlotUpdated(player, destPos, wasEmpty);
+    if (dropsOffhand) {
+        // Landet irgendwo in den Taschen, einfacher neu zählen
+        player->AutoUnequipOffhandIfNeed();
+        inventory.MarkDirty();
     }
+    LOG_INFO("module", "AI-GEAR: Upgrade angelegt! (Slot: {}, Score {} -> {})", slot, currentScore, newScore);
+    return true;
 }
 
-class CreatureCollector {
-public:
-    std::vector<Creature*> foundCreatures;
-    Player* i_player;
-    CreatureCollector(Player* player) : i_player(player) {}
-
-    void Visit(CreatureMapType& m) {
-        for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr) {
-            Creature* creature = itr->GetSource();
-            if (creature) {
-                if (!creature->IsInWorld()) continue;
-                if (creature->IsTotem() || creature->IsPet()) continue;
-                if (creature->GetCreatureTemplate()->type == CREATURE_TYPE_CRITTER) continue;
-
-                if (!creature->IsAlive()) {
-                    if (i_player->GetDistance(creature) > 10.0f) continue;
-                }
-                else if (i_player->GetDistance(creature) > 50.0f) continue;
-
-                foundCreatures.push_back(creature);
-            }
+// Ein Durchlauf nach einem Loot-Burst statt pro Item. Ein abgelegtes Item wird erneut
+// geprüft, z.B. der alte Ring gegen den zweiten Ring-Slot. Jeder Tausch erhöht den
+// Gesamt-Score, das Budget ist nur eine Absicherung.
+static void OptimizeGear(Player* player, AIInventorySummary& inventory, std::vector<uint16>& candidates) {
+    bool upgraded = false;
+    uint32 budget = uint32(candidates.size()) * 2 + 4;
+    while (!candidates.empty() && budget--) {
+        uint16 srcPos = candidates.back();
+        candidates.pop_back();
+        if (TryEquipBest(player, inventory, srcPos)) {
+            upgraded = true;
+            candidates.push_back(srcPos);
         }
     }
-    template<class SKIP> void Visit(GridRefMgr<SKIP>&) {}
-};
+    candidates.clear();
 
-uint32 GetFreeBagSlots(Player* player) {
-    uint32 freeSlots = 0;
-    for (uint8 slot = INVENTORY_SLOT_ITEM_START; slot < INVENTORY_SLOT_ITEM_END; ++slot) {
-        if (!player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot)) freeSlots++;
-    }
-    for (uint8 bag = INVENTORY_SLOT_BAG_START; bag < INVENTORY_SLOT_BAG_END; ++bag) {
-        Bag* bagItem = (Bag*)player->GetItemByPos(INVENTORY_SLOT_BAG_0, bag);
-        if (bagItem) freeSlots += bagItem->GetFreeSlots();
+    if (upgraded) {
+        player->PlayDistanceSound(120, player);
+        SetEquippedUpgrade(player);
     }
-    return freeSlots;
 }
 
-// --- SERVER THREAD ---
-//
-// Multi-Client: Thread pro Client (synchrones IO). Jeder Client bekommt den State-Stream
-// unabhängig (kein globales "g_HasNewState=false" mehr).
-//
-// State-Push wird über g_StateVersion getriggert: OnUpdate inkrementiert die Version,
-// jeder Client merkt sich seine letzte gesehene Version.
-//
-static void HandleAIClient(tcp::socket socket)
-{
-    try
-    {
-        LOG_INFO("module", ">>> CLIENT VERBUNDEN! <<<");
-
-        // optional: kleine Latenz-Optimierung
-        boost::system::error_code ec;
-        socket.set_option(tcp::no_delay(true), ec);
-
-        char data_[8192];
-        std::string incomingBuffer;
-
-        uint64_t lastVersion = 0;
-        auto lastSend = std::chrono::steady_clock::now();
+// Nur Bots sind steuerbar, daher reicht die Registry statt der globalen Player-Maps.
+// Handle und GUID sind direkte Lookups, der Name ist nur noch für das Text-Protokoll da.
+static AIBotEntry* ResolveBot(AICommand const& cmd) {
+    if (cmd.botHandle != AI_INVALID_BOT_HANDLE) return sAIBotRegistry->FindByIndex(cmd.botHandle);
+    if (cmd.playerGuid) return sAIBotRegistry->FindByGuid(ObjectGuid(cmd.playerGuid));
+    return sAIBotRegistry->FindByName(cmd.playerName);
+}
 
-        // Initial-State sofort senden
-        {
-            std::string initial;
-            {
-                std::lock_guard<std::mutex> lock(g_Mutex);
-                initial = g_CurrentJsonState + "\n";
+static bool g_LootRewardByScore = false;
+
+// Scratch-Puffer, ExecuteCommand läuft nur im World-Thread
+static std::vector<bool> g_LootEmptyBefore;
+static std::vector<uint16> g_LootedPositions;
+static std::vector<uint16> g_SellPositions;
+
+// Gemeinsam für loot_guid/sell_grey und die Makros loot_all/vendor_run
+
+// true, wenn die Leiche in Reichweite war und geplündert wurde
+static bool LootCorpse(Player* player, AIInventorySummary& inventory, Creature* target) {
+    if (!target->isDead() || player->GetDistance(target) > 10.0f) return false;
+    AIOwnItemChange ownChange;
+    player->SendLoot(target->GetGUID(), LOOT_CORPSE);
+    Loot* loot = &target->loot;
+    uint32 gold = loot->gold;
+    if (gold > 0) {
+        loot->gold = 0; player->ModifyMoney(gold);
+        player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, gold);
+        WorldPacket data(SMSG_LOOT_MONEY_NOTIFY, 4 + 1); data << uint32(gold); data << uint8(1); player->GetSession()->SendPacket(&data);
+        AddLootCopper(player, gold);
+    }
+    for (uint8 i = 0; i < loot->items.size(); ++i) {
+        LootItem* item = loot->LootItemInSlot(i, player);
+        if (item && !item->is_looted && !item->freeforall && !item->needs_quest) {
+            ItemPosCountVec dest;
+            InventoryResult msg = player->CanStoreNewItem(NULL_BAG, NULL_SLOT, dest, item->itemid, item->count);
+            if (msg == EQUIP_ERR_OK) {
+                g_LootEmptyBefore.clear();
+                for (ItemPosCount const& pos : dest) g_LootEmptyBefore.push_back(!player->GetItemByPos(pos.pos));
+                Item* newItem = player->StoreNewItem(dest, item->itemid, true);
+                for (std::size_t d = 0; d < dest.size(); ++d) inventory.OnSlotUpdated(player, dest[d].pos, g_LootEmptyBefore[d]);
+                item->count = 0; item->is_looted = true;
+                if (newItem) player->SendNewItem(newItem, 1, false, true);
+                g_LootedPositions.push_back(dest[0].pos);
+                // AIController.ItemScore.LootReward: Item-Score statt Anzahl als Reward
+                if (g_LootRewardByScore) AddLootScore(player, uint32(std::max(sAIItemScore->GetScore(item->itemid, player->getClass()), 1)));
+                else AddLootScore(player, 1);
             }
-            boost::asio::write(socket, boost::asio::buffer(initial));
-            lastVersion = g_StateVersion.load(std::memory_order_relaxed);
-            lastSend = std::chrono::steady_clock::now();
         }
+    }
+    OptimizeGear(player, inventory, g_LootedPositions);
+    target->RemoveFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
+    target->AllLootRemovedFromCorpse();
+    player->SendLootRelease(player->GetLootGUID());
+    player->SetSelection(ObjectGuid::Empty); player->SetTarget(ObjectGuid::Empty); player->AttackStop();
+    return true;
+}
 
-        while (true)
-        {
-            // 1) State senden, wenn neue Version oder Keepalive (alle 500ms)
-            std::string msg;
-            uint64_t v = g_StateVersion.load(std::memory_order_relaxed);
-
-            if (v != lastVersion)
-            {
-                std::lock_guard<std::mutex> lock(g_Mutex);
-                msg = g_CurrentJsonState + "\n";
-                lastVersion = v;
-            }
-            else
-            {
-                auto now = std::chrono::steady_clock::now();
-                if (now - lastSend >= std::chrono::milliseconds(500))
-                {
-                    std::lock_guard<std::mutex> lock(g_Mutex);
-                    msg = g_CurrentJsonState + "\n";
-                }
-            }
-
-            if (!msg.empty())
-            {
-                boost::asio::write(socket, boost::asio::buffer(msg));
-                lastSend = std::chrono::steady_clock::now();
-            }
-
-            // 2) Eingehende Commands lesen (non-blocking-ish über available())
-            if (socket.available() > 0)
-            {
-                boost::system::error_code error;
-                size_t length = socket.read_some(boost::asio::buffer(data_), error);
-
-                if (error == boost::asio::error::eof)
-                    break; // client disconnected
-                if (error)
-                    throw boost::system::system_error(error);
-
-                incomingBuffer.append(data_, length);
-
-                size_t newlinePos = 0;
-                while ((newlinePos = incomingBuffer.find('\n')) != std::string::npos)
-                {
-                    std::string line = incomingBuffer.substr(0, newlinePos);
-                    incomingBuffer.erase(0, newlinePos + 1);
-                    if (line.empty())
-                        continue;
-
-                    // Format: playerName:actionType:value
-                    size_t p1 = line.find(':');
-                    size_t p2 = line.find(':', p1 + 1);
-                    if (p1 != std::string::npos && p2 != std::string::npos)
-                    {
-                        AICommand cmd;
-                        cmd.playerName = line.substr(0, p1);
-                        cmd.actionType = line.substr(p1 + 1, p2 - p1 - 1);
-                        cmd.value = line.substr(p2 + 1);
-
-                        std::lock_guard<std::mutex> lock(g_Mutex);
-                        g_CommandQueue.push(cmd);
-                    }
-                }
-            }
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
+// Verdientes Kupfer; 0 auch, wenn der Händler zu weit weg ist
+static uint32 SellToVendor(Player* player, AIInventorySummary& inventory, Creature* vendor) {
+    if (player->GetDistance(vendor) > 15.0f) return 0;
+    player->StopMoving();
+    uint32 totalMoney = 0;
+    // Index statt Scan über Rucksack und alle Taschen; Kopie, weil OnSlotUpdated ihn ändert
+    AIOwnItemChange ownChange;
+    g_SellPositions = inventory.GetSellable(player);
+    for (uint16 pos : g_SellPositions) {
+        Item* item = player->GetItemByPos(pos);
+        if (!item || !IsSellableItem(item->GetTemplate())) continue;
+        totalMoney += item->GetTemplate()->SellPrice * item->GetCount();
+        player->DestroyItem(pos >> 8, pos & 255, true);
+        inventory.OnSlotUpdated(player, pos, false);
     }
-    catch (std::exception const& e)
-    {
-        LOG_ERROR("module", "Verbindung verloren: {}", e.what());
+    if (totalMoney > 0) {
+        player->ModifyMoney(totalMoney);
+        player->PlayDistanceSound(120, player);
+        AddLootCopper(player, totalMoney);
     }
-
-    LOG_INFO("module", ">>> CLIENT GETRENNT <<<");
+    player->SetSelection(ObjectGuid::Empty); player->SetTarget(ObjectGuid::Empty);
+    return totalMoney;
 }
 
-void AIServerThread()
-{
-    try
-    {
-        boost::asio::io_context io_context;
-        tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v4(), 5000));
-        LOG_INFO("module", ">>> AI-SOCKET: Lausche auf Port 5000... <<<");
-
-        while (true)
-        {
-            tcp::socket socket(io_context);
-            acceptor.accept(socket);
-
-            // Thread pro Client
-            std::thread(&HandleAIClient, std::move(socket)).detach();
+static void ExecuteCommand(Player* player, AIInventorySummary& inventory, AICommand const& cmd) {
+    switch (cmd.action) {
+    case AI_ACTION_SAY: player->Say(cmd.text, LANG_UNIVERSAL); break;
+    case AI_ACTION_STOP: player->GetMotionMaster()->Clear(); player->GetMotionMaster()->MoveIdle(); break;
+    case AI_ACTION_TURN_LEFT:
+    case AI_ACTION_TURN_RIGHT: {
+        float o = player->GetOrientation();
+        float step = (cmd.action == AI_ACTION_TURN_LEFT) ? 0.5f : -0.5f;
+        o += step; if (o > 6.283f) o -= 6.283f; if (o < 0) o += 6.283f;
+        player->SetFacingTo(o);
+        break;
+    }
+    case AI_ACTION_MOVE_FORWARD: {
+        float o = player->GetOrientation();
+        float x = player->GetPositionX() + (3.0f * std::cos(o));
+        float y = player->GetPositionY() + (3.0f * std::sin(o));
+        float z = player->GetPositionZ();
+        player->UpdateGroundPositionZ(x, y, z);
+        player->GetMotionMaster()->MovePoint(1, x, y, z);
+        break;
+    }
+    case AI_ACTION_TARGET_NEAREST: {
+        float range = cmd.range > 0.0f ? cmd.range : 30.0f;
+        Unit* target = player->SelectNearbyTarget(nullptr, range);
+        if (target && player->IsValidAttackTarget(target)) {
+            player->SetSelection(target->GetGUID());
+            player->SetTarget(target->GetGUID());
+            player->SetFacingToObject(target);
+        }
+        break;
+    }
+    case AI_ACTION_CAST: {
+        uint32 spellId = cmd.spellId;
+        Unit* target = player->GetSelectedUnit();
+        if (spellId == 2050) target = player;
+        else if (spellId == 585) {
+            if (!target || target == player) {
+                target = player->SelectNearbyTarget(nullptr, 30.0f);
+                if (target && !player->IsValidAttackTarget(target)) target = nullptr;
+            }
+        }
+        else if (!target) target = player;
+        if (target) {
+            if (!(spellId == 585 && target == player)) player->CastSpell(target, spellId, false);
         }
+        break;
     }
-    catch (std::exception const& e)
-    {
-        LOG_ERROR("module", "Server Crash: {}", e.what());
+    case AI_ACTION_MOVE_TO: {
+        float tx = cmd.x; float ty = cmd.y; float tz = cmd.z;
+        player->UpdateGroundPositionZ(tx, ty, tz);
+        Position pos(tx, ty, tz, 0.0f);
+        player->GetMotionMaster()->MovePoint(1, pos, (ForcedMovement)0, 0.0f, true);
+        break;
+    }
+    case AI_ACTION_TARGET_GUID: {
+        ObjectGuid guid = ObjectGuid(cmd.targetGuid);
+        Unit* target = ObjectAccessor::GetUnit(*player, guid);
+        if (target) { player->SetSelection(target->GetGUID()); player->SetTarget(target->GetGUID()); player->SetFacingToObject(target); player->AttackStop(); }
+        break;
+    }
+    case AI_ACTION_LOOT_GUID: {
+        Creature* target = ObjectAccessor::GetCreature(*player, ObjectGuid(cmd.targetGuid));
+        if (target) LootCorpse(player, inventory, target);
+        break;
+    }
+    case AI_ACTION_SELL_GREY: {
+        Creature* vendor = ObjectAccessor::GetCreature(*player, ObjectGuid(cmd.targetGuid));
+        if (vendor) SellToVendor(player, inventory, vendor);
+        break;
+    }
+    default:
+        break;
     }
 }
 
@@ -507,464 +387,523 @@ void AIServerThread()
 class AIControllerWorldScript : public WorldScript {
 private:
     uint32 _fastTimer;
-    uint32 _slowTimer;
     uint32 _faceTimer;
-    std::string _cachedNearbyMobsJson;
-    void CollectOnlinePlayers(std::vector<Player*>& players) {
-        std::shared_lock lock(*HashMapHolder<Player>::GetLock());
-        players.reserve(ObjectAccessor::GetPlayers().size());
-        for (auto const& it : ObjectAccessor::GetPlayers()) {
-            Player* player = it.second;
-            if (!player || !player->IsInWorld()) {
-                continue;
-            }
-            players.push_back(player);
+    uint32 _faceCarry;
+    uint32 _faceCursor;
+
+    // AIController.* (OnAfterConfigLoad, auch bei .reload config)
+    uint32 _stateInterval;
+    uint32 _faceInterval;
+    bool _faceSpread;
+    bool _stateOnChange;
+    std::vector<std::string> _observedPlayers;
+    uint64 _watchHash;
+    AIPerceptionCache _perception;
+    AIStateBuilder _stateBuilder;
+    std::vector<Player*> _snapshotPlayers;
+
+    // Beobachtungsfelder, die beim letzten Snapshot abonniert waren; parallel zu _snapshotPlayers
+    AIObservationCollector _observation;
+    std::vector<AIPlayerObservation> _observations;
+    uint32 _observationFields;
+    uint64 _observationHash;
+
+    std::vector<AICommand> _commandBatch;
+    std::vector<AIRosterEntry> _roster;
+    std::vector<AIStepAck> _appliedSteps;
+    std::vector<AIEpisodeEvent> _episodes;
+    std::vector<AIMacroEvent> _macroEvents;
+    uint32 _macroTimeout;
+    // Bots aus der Registry plus die beobachteten Menschen aus AIController.State.ObservedPlayers
+    void CollectSnapshotPlayers(std::vector<Player*>& players) {
+        players.reserve(sAIBotRegistry->GetCount() + _observedPlayers.size());
+        sAIBotRegistry->VisitOnline([&](AIBotEntry& bot) {
+            if (bot.player->IsInWorld()) players.push_back(bot.player);
+        });
+        for (std::string const& name : _observedPlayers) {
+            Player* player = ObjectAccessor::FindPlayerByName(name);
+            if (player && player->IsInWorld() && !AIBotRegistry::IsBot(player)) players.push_back(player);
         }
     }
-public:
-    AIControllerWorldScript() : WorldScript("AIControllerWorldScript"), _fastTimer(0), _slowTimer(0), _faceTimer(0), _cachedNearbyMobsJson("[]") {}
-    void OnStartup() override { std::thread(AIServerThread).detach(); }
-
-    void OnUpdate(uint32 diff) override {
-        _fastTimer += diff; _slowTimer += diff; _faceTimer += diff;
-
-        if (_faceTimer >= 150) {
+    static void FaceSelectedTarget(Player* p) {
+        if (p->IsInCombat() || p->HasUnitState(UNIT_STATE_CASTING)) {
+            Unit* target = p->GetSelectedUnit();
+            if (target) p->SetFacingToObject(target);
+        }
+    }
+    // Nur Bots, Menschen drehen sich selbst. Mit Facing.Spread ist jeder Bot einmal pro
+    // Intervall dran, verteilt über alle Ticks statt alle auf einmal.
+    void UpdateFacing(uint32 diff) {
+        uint32 slots = sAIBotRegistry->GetSlotCount();
+        if (!_faceInterval || !slots) return;
+        uint32 count;
+        if (_faceSpread) {
+            _faceCarry += slots * diff;
+            count = std::min<uint32>(_faceCarry / _faceInterval, slots);
+            _faceCarry = std::min<uint32>(_faceCarry - count * _faceInterval, slots * _faceInterval);
+        } else {
+            _faceTimer += diff;
+            if (_faceTimer < _faceInterval) return;
             _faceTimer = 0;
-            auto const& sessions = sWorldSessionMgr->GetAllSessions();
-            for (auto const& pair : sessions) {
-                Player* p = pair.second->GetPlayer();
-                if (!p) continue;
-                if (p->IsInCombat() || p->HasUnitState(UNIT_STATE_CASTING)) {
-                    Unit* target = p->GetSelectedUnit();
-                    if (target) p->SetFacingToObject(target);
-                }
+            _faceCursor = 0;
+            count = slots;
+        }
+        for (uint32 i = 0; i < count; ++i) {
+            if (_faceCursor >= slots) _faceCursor = 0;
+            AIBotEntry const* bot = sAIBotRegistry->FindByIndex(_faceCursor++);
+            if (bot && bot->player && bot->player->IsInWorld()) FaceSelectedTarget(bot->player);
+        }
+    }
+    // reset/checkpoint brauchen den Registry-Eintrag, nicht nur den Player
+    // Aufgezeichnet wird eine Zeile pro Bot, der wirklich zurückgesetzt wurde
+    void ResetBot(AIBotEntry& bot, AICommand const& cmd, AIEpisodeEvent& event) {
+        if (!bot.player || !bot.player->IsInWorld()) return;
+        if (bot.macro.IsActive()) FinishMacro(bot, AI_MACRO_CANCELLED);
+        if (ResetEpisode(bot.player, bot.checkpoint.get()) == AI_RESET_TELEPORTED) ++event.teleported;
+        bot.inventory.MarkDirty();
+        ++event.bots;
+        sAITrajectory->RecordCommand(cmd, bot.guid.GetRawValue(), bot.index);
+    }
+    void HandleEpisodeCommand(AICommand const& cmd) {
+        AIEpisodeEvent event;
+        event.session = cmd.sessionId;
+        event.episode = cmd.episodeId;
+
+        if (cmd.action == AI_ACTION_RESET_BATCH) {
+            if (cmd.botHandles.empty())
+                sAIBotRegistry->VisitOnline([&](AIBotEntry& bot) { ResetBot(bot, cmd, event); });
+            for (uint32 handle : cmd.botHandles)
+                if (AIBotEntry* bot = sAIBotRegistry->FindByIndex(handle)) ResetBot(*bot, cmd, event);
+        } else {
+            AIBotEntry* bot = ResolveBot(cmd);
+            if (!bot || !bot->player || !bot->player->IsInWorld()) return;
+            if (cmd.action == AI_ACTION_CHECKPOINT) {
+                if (!bot->checkpoint) bot->checkpoint = std::make_unique<AIEpisodeCheckpoint>();
+                CaptureEpisodeCheckpoint(bot->player, *bot->checkpoint);
+                sAITrajectory->RecordCommand(cmd, bot->guid.GetRawValue(), bot->index);
+                return;
             }
+            ResetBot(*bot, cmd, event);
         }
 
-        g_QueryHolderProcessor.ProcessReadyCallbacks();
-
-        {
-            std::lock_guard<std::mutex> lock(g_Mutex);
-            while (!g_CommandQueue.empty()) {
-                AICommand cmd = g_CommandQueue.front();
-                g_CommandQueue.pop();
-                Player* player = ObjectAccessor::FindPlayerByName(cmd.playerName);
-                if (!player) continue;
-                if (!IsBotControlledPlayer(player)) continue;
-                if (cmd.actionType == "say") player->Say(cmd.value, LANG_UNIVERSAL);
-                else if (cmd.actionType == "stop") { player->GetMotionMaster()->Clear(); player->GetMotionMaster()->MoveIdle(); }
-                else if (cmd.actionType == "turn_left" || cmd.actionType == "turn_right") {
-                    float o = player->GetOrientation();
-                    float step = (cmd.actionType == "turn_left") ? 0.5f : -0.5f;
-                    o += step; if (o > 6.283f) o -= 6.283f; if (o < 0) o += 6.283f;
-                    player->SetFacingTo(o);
-                }
-                else if (cmd.actionType == "move_forward") {
-                    float o = player->GetOrientation();
-                    float x = player->GetPositionX() + (3.0f * std::cos(o));
-                    float y = player->GetPositionY() + (3.0f * std::sin(o));
-                    float z = player->GetPositionZ();
-                    player->UpdateGroundPositionZ(x, y, z);
-                    player->GetMotionMaster()->MovePoint(1, x, y, z);
-                }
-                else if (cmd.actionType == "target_nearest") {
-                    float range = 30.0f;
-                    if (!cmd.value.empty()) {
-                        try {
-                            float parsed = std::stof(cmd.value);
-                            if (parsed > 0.0f) range = parsed;
-                        }
-                        catch (std::exception const&) {
-                        }
-                    }
-                    Unit* target = player->SelectNearbyTarget(nullptr, range);
-                    if (target && player->IsValidAttackTarget(target)) {
-                        player->SetSelection(target->GetGUID());
-                        player->SetTarget(target->GetGUID());
-                        player->SetFacingToObject(target);
-                    }
-                }
-                else if (cmd.actionType == "cast") {
-                    uint32 spellId = std::stoi(cmd.value);
-                    Unit* target = player->GetSelectedUnit();
-                    if (spellId == 2050) target = player;
-                    else if (spellId == 585) {
-                        if (!target || target == player) {
-                            target = player->SelectNearbyTarget(nullptr, 30.0f);
-                            if (target && !player->IsValidAttackTarget(target)) target = nullptr;
-                        }
-                    }
-                    else if (!target) target = player;
-                    if (target) {
-                        if (!(spellId == 585 && target == player)) player->CastSpell(target, spellId, false);
-                    }
-                }
-                else if (cmd.actionType == "reset") {
-                    player->CombatStop(true); player->AttackStop(); player->GetMotionMaster()->Clear();
-                    if (!player->isDead()) { player->ResurrectPlayer(1.0f, false); player->SpawnCorpseBones(); }
-                    player->SetHealth(player->GetMaxHealth()); player->SetPower(player->getPowerType(), player->GetMaxPower(player->getPowerType()));
-                    player->RemoveAllSpellCooldown(); player->RemoveAllAuras();
-                    player->TeleportTo(player->m_homebindMapId, player->m_homebindX, player->m_homebindY, player->m_homebindZ, player->GetOrientation());
-                }
-                else if (cmd.actionType == "move_to") {
-                    std::string val = cmd.value;
-                    size_t p1 = val.find(':');
-                    size_t p2 = val.find(':', p1 + 1);
-                    if (p1 != std::string::npos && p2 != std::string::npos) {
-                        float tx = std::stof(val.substr(0, p1)); float ty = std::stof(val.substr(p1 + 1, p2 - p1 - 1)); float tz = std::stof(val.substr(p2 + 1));
-                        player->UpdateGroundPositionZ(tx, ty, tz);
-                        Position pos(tx, ty, tz, 0.0f);
-                        player->GetMotionMaster()->MovePoint(1, pos, (ForcedMovement)0, 0.0f, true);
-                    }
-                }
-                else if (cmd.actionType == "target_guid") {
-                    ObjectGuid guid = ObjectGuid(std::stoull(cmd.value));
-                    Unit* target = ObjectAccessor::GetUnit(*player, guid);
-                    if (target) { player->SetSelection(target->GetGUID()); player->SetTarget(target->GetGUID()); player->SetFacingToObject(target); player->AttackStop(); }
-                }
-                else if (cmd.actionType == "loot_guid") {
-                    ObjectGuid guid = ObjectGuid(std::stoull(cmd.value));
-                    Creature* target = ObjectAccessor::GetCreature(*player, guid);
-                    if (target && target->isDead()) {
-                        if (player->GetDistance(target) <= 10.0f) {
-                            player->SendLoot(target->GetGUID(), LOOT_CORPSE);
-                            Loot* loot = &target->loot;
-                            uint32 gold = loot->gold;
-                            if (gold > 0) {
-                                loot->gold = 0; player->ModifyMoney(gold);
-                                player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, gold);
-                                WorldPacket data(SMSG_LOOT_MONEY_NOTIFY, 4 + 1); data << uint32(gold); data << uint8(1); player->GetSession()->SendPacket(&data);
-                                AddLootCopper(player, gold);
-                            }
-                            for (uint8 i = 0; i < loot->items.size(); ++i) {
-                                LootItem* item = loot->LootItemInSlot(i, player);
-                                if (item && !item->is_looted && !item->freeforall && !item->needs_quest) {
-                                    ItemPosCountVec dest;
-                                    InventoryResult msg = player->CanStoreNewItem(NULL_BAG, NULL_SLOT, dest, item->itemid, item->count);
-                                    if (msg == EQUIP_ERR_OK) {
-                                        Item* newItem = player->StoreNewItem(dest, item->itemid, true);
-                                        item->count = 0; item->is_looted = true;
-                                        if (newItem) player->SendNewItem(newItem, 1, false, true);
-                                        TryEquipIfBetter(player, dest[0].pos);
-                                        ItemTemplate const* proto = sObjectMgr->GetItemTemplate(item->itemid);
-                                        if (proto) { AddLootScore(player, 1); }
-                                    }
-                                }
-                            }
-                            target->RemoveFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
-                            target->AllLootRemovedFromCorpse();
-                            player->SendLootRelease(player->GetLootGUID());
-                            player->SetSelection(ObjectGuid::Empty); player->SetTarget(ObjectGuid::Empty); player->AttackStop();
-                        }
-                    }
-                }
-                else if (cmd.actionType == "sell_grey") {
-                    ObjectGuid guid = ObjectGuid(std::stoull(cmd.value));
-                    Creature* vendor = ObjectAccessor::GetCreature(*player, guid);
-                    if (vendor && player->GetDistance(vendor) <= 15.0f) {
-                        player->StopMoving();
-                        uint32 totalMoney = 0;
-                        for (uint8 i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i) {
-                            if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, i)) {
-                                ItemTemplate const* proto = item->GetTemplate();
-                                if (proto->SellPrice > 0 && proto->ItemId != 6948) {
-                                    uint32 price = proto->SellPrice * item->GetCount();
-                                    totalMoney += price; player->DestroyItem(INVENTORY_SLOT_BAG_0, i, true);
-                                }
-                            }
-                        }
-                        for (uint8 bag = INVENTORY_SLOT_BAG_START; bag < INVENTORY_SLOT_BAG_END; ++bag) {
-                            if (Bag* bagItem = (Bag*)player->GetItemByPos(INVENTORY_SLOT_BAG_0, bag)) {
-                                for (uint8 i = 0; i < bagItem->GetBagSize(); ++i) {
-                                    if (Item* item = bagItem->GetItemByPos(i)) {
-                                        ItemTemplate const* proto = item->GetTemplate();
-                                        if (proto->SellPrice > 0 && proto->ItemId != 6948) {
-                                            uint32 price = proto->SellPrice * item->GetCount();
-                                            totalMoney += price; player->DestroyItem(bag, i, true);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        if (totalMoney > 0) {
-                            player->ModifyMoney(totalMoney);
-                            player->PlayDistanceSound(120, player);
-                            AddLootCopper(player, totalMoney);
-                        }
-                        player->SetSelection(ObjectGuid::Empty); player->SetTarget(ObjectGuid::Empty);
-                    }
-                }
+        MarkStateDirty();
+        if (event.episode) _episodes.push_back(event);
+    }
+    // --- MACROS ---
+    static bool IsMacroAction(AIAction action) {
+        return action == AI_ACTION_LOOT_ALL || action == AI_ACTION_ATTACK || action == AI_ACTION_VENDOR_RUN;
+    }
+    // say und cast laufen neben einem Makro, alles andere übernimmt die Steuerung
+    static bool CancelsMacro(AIAction action) {
+        return action != AI_ACTION_SAY && action != AI_ACTION_CAST;
+    }
+    void FinishMacro(AIBotEntry& bot, AIMacroStatus status) {
+        AIMacroEvent event;
+        event.session = bot.macro.session;
+        event.handle = bot.index;
+        event.guid = bot.guid.GetRawValue();
+        event.action = bot.macro.action;
+        event.status = status;
+        event.value = bot.macro.value;
+        // Bei Abbruch steuert schon das nächste Kommando, sonst nicht weiterlaufen
+        if (status != AI_MACRO_CANCELLED && bot.macro.moving && bot.player) {
+            bot.player->GetMotionMaster()->Clear();
+            bot.player->StopMoving();
+        }
+        bot.macro.Clear();
+        _macroEvents.push_back(event);
+        MarkStateDirty();
+    }
+    void StartMacro(AIBotEntry& bot, AICommand const& cmd) {
+        if (bot.macro.IsActive()) FinishMacro(bot, AI_MACRO_CANCELLED);
+        Player* player = bot.player;
+        AIMacroState& macro = bot.macro;
+        macro.action = cmd.action;
+        macro.session = cmd.sessionId;
+        macro.startedAt = getMSTime();
+        switch (cmd.action) {
+        case AI_ACTION_LOOT_ALL:
+            FindLootableCorpses(player, cmd.range > 0.0f ? cmd.range : 30.0f, macro.corpses);
+            if (macro.corpses.empty()) FinishMacro(bot, AI_MACRO_NO_TARGET);
+            break;
+        case AI_ACTION_ATTACK:
+            macro.target = ObjectGuid(cmd.targetGuid);
+            break;
+        case AI_ACTION_VENDOR_RUN:
+            if (Creature* vendor = FindNearestVendor(player, cmd.range > 0.0f ? cmd.range : 100.0f)) macro.target = vendor->GetGUID();
+            else FinishMacro(bot, AI_MACRO_NO_TARGET);
+            break;
+        default:
+            macro.Clear();
+            break;
+        }
+    }
+    void UpdateMacro(AIBotEntry& bot, uint32 now) {
+        Player* player = bot.player;
+        AIMacroState& macro = bot.macro;
+        if (!player->IsAlive()) return FinishMacro(bot, AI_MACRO_DIED);
+        if (_macroTimeout && getMSTimeDiff(macro.startedAt, now) >= _macroTimeout) return FinishMacro(bot, AI_MACRO_TIMEOUT);
+
+        switch (macro.action) {
+        case AI_ACTION_LOOT_ALL: {
+            // Schon geplünderte (auch von anderen) oder verschwundene Leichen überspringen
+            Creature* corpse = nullptr;
+            while (!macro.corpses.empty()) {
+                corpse = ObjectAccessor::GetCreature(*player, macro.corpses.back());
+                if (corpse && corpse->isDead() && corpse->HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE)) break;
+                corpse = nullptr;
+                macro.corpses.pop_back();
+                macro.ResetMove();
             }
+            if (!corpse) return FinishMacro(bot, AI_MACRO_DONE);
+
+            AIMacroMoveResult move = ApproachTarget(player, macro, corpse, AI_MACRO_LOOT_DISTANCE);
+            if (move == AI_MACRO_MOVING) return;
+            // Unerreichbare Leiche kostet nicht das ganze Makro
+            if (move == AI_MACRO_ARRIVED && LootCorpse(player, bot.inventory, corpse)) ++macro.value;
+            macro.corpses.pop_back();
+            macro.ResetMove();
+            break;
         }
-
-        if (_fastTimer >= 400) {
-            _fastTimer = 0;
-            std::stringstream ss;
-            ss << "{ \"players\": [";
-            bool first = true;
-            std::vector<Player*> players;
-            CollectOnlinePlayers(players);
-            for (Player* p : players) {
-                if (!p) continue;
-                if (!first) ss << ", ";
-                first = false;
-                ss << "{";
-                ss << "\"name\": \"" << p->GetName() << "\", ";
-                ss << "\"hp\": " << p->GetHealth() << ", ";
-                ss << "\"max_hp\": " << p->GetMaxHealth() << ", ";
-                ss << "\"power\": " << p->GetPower(p->getPowerType()) << ", ";
-                ss << "\"max_power\": " << p->GetMaxPower(p->getPowerType()) << ", ";
-                ss << "\"level\": " << (int)p->GetLevel() << ", ";
-                ss << "\"x\": " << p->GetPositionX() << ", ";
-                ss << "\"y\": " << p->GetPositionY() << ", ";
-                ss << "\"z\": " << p->GetPositionZ() << ", ";
-                ss << "\"o\": " << p->GetOrientation() << ", ";
-                ss << "\"combat\": \"" << (p->IsInCombat() ? "true" : "false") << "\", ";
-                ss << "\"casting\": \"" << (p->HasUnitState(UNIT_STATE_CASTING) ? "true" : "false") << "\", ";
-                ss << "\"free_slots\": " << GetFreeBagSlots(p) << ", ";
-                AIPlayerEvents ev = ConsumePlayerEvents(p);
-
-                ss << "\"equipped_upgrade\": \"" << (ev.equipped_upgrade ? "true" : "false") << "\", ";
-                Unit* target = p->GetSelectedUnit();
-                std::string tStatus = "none"; uint32 tHp = 0; float tx = 0, ty = 0, tz = 0;
-                if (target) {
-                    tStatus = target->IsAlive() ? "alive" : "dead";
-                    tHp = target->GetHealth();
-                    tx = target->GetPositionX(); ty = target->GetPositionY(); tz = target->GetPositionZ();
-                }
-                ss << "\"target_status\": \"" << tStatus << "\", ";
-                ss << "\"target_hp\": " << tHp << ", ";
-                ss << "\"xp_gained\": " << ev.xp_gained << ", ";
-                ss << "\"loot_copper\": " << ev.loot_copper << ", ";
-                ss << "\"loot_score\": " << ev.loot_score << ", ";
-                ss << "\"leveled_up\": \"" << (ev.leveled_up ? "true" : "false") << "\", ";
-                ss << "\"tx\": " << tx << ", ";
-                ss << "\"ty\": " << ty << ", ";
-                ss << "\"tz\": " << tz << ", ";
-                if (_cachedNearbyMobsJson.empty()) _cachedNearbyMobsJson = "[]";
-                ss << "\"nearby_mobs\": " << _cachedNearbyMobsJson;
-                ss << "}";
+        case AI_ACTION_ATTACK: {
+            Unit* target = ObjectAccessor::GetUnit(*player, macro.target);
+            if (!target) return FinishMacro(bot, AI_MACRO_NO_TARGET);
+            if (target->isDead()) {
+                player->AttackStop();
+                return FinishMacro(bot, AI_MACRO_DONE);
             }
-            ss << "] }";
-            { std::lock_guard<std::mutex> lock(g_Mutex); g_CurrentJsonState = ss.str(); g_HasNewState = true; }
-            g_StateVersion.fetch_add(1, std::memory_order_relaxed);
-
-        }
-
-        if (_slowTimer >= 2000) {
-            _slowTimer = 0;
-            std::vector<Player*> players;
-            CollectOnlinePlayers(players);
-            if (!players.empty()) {
-                for (Player* p : players) {
-                    if (!p) continue;
-                    if (p) {
-                        CreatureCollector collector(p);
-                        Cell::VisitObjects(p, collector, 50.0f);
-                        std::stringstream mobSS;
-                        mobSS << "[";
-                        bool firstMob = true;
-                        for (Creature* c : collector.foundCreatures) {
-                            if (!firstMob) mobSS << ", ";
-                            mobSS << "{";
-                            mobSS << "\"guid\": \"" << c->GetGUID().GetRawValue() << "\", ";
-                            mobSS << "\"name\": \"" << c->GetName() << "\", ";
-                            mobSS << "\"level\": " << (int)c->GetLevel() << ", ";
-                            mobSS << "\"attackable\": " << (p->IsValidAttackTarget(c) ? "1" : "0") << ", ";
-                            mobSS << "\"vendor\": " << (c->IsVendor() ? "1" : "0") << ", ";
-                            uint64 targetGuid = 0;
-                            if (c->GetTarget()) targetGuid = c->GetTarget().GetRawValue();
-                            mobSS << "\"target\": \"" << targetGuid << "\", ";
-                            mobSS << "\"hp\": " << c->GetHealth() << ", ";
-                            mobSS << "\"x\": " << c->GetPositionX() << ", ";
-                            mobSS << "\"y\": " << c->GetPositionY() << ", ";
-                            mobSS << "\"z\": " << c->GetPositionZ();
-                            mobSS << "}";
-                            firstMob = false;
-                        }
-                        mobSS << "]";
-                        _cachedNearbyMobsJson = mobSS.str();
-                        break;
-                    }
-                }
+            if (!player->IsValidAttackTarget(target)) return FinishMacro(bot, AI_MACRO_NO_TARGET);
+            // MoveChase macht die Wegfindung und folgt dem Ziel selbst
+            if (player->GetVictim() != target) {
+                player->SetSelection(target->GetGUID());
+                player->SetTarget(target->GetGUID());
+                player->Attack(target, true);
+                player->GetMotionMaster()->MoveChase(target);
+                macro.moving = true;
             }
+            break;
+        }
+        case AI_ACTION_VENDOR_RUN: {
+            Creature* vendor = ObjectAccessor::GetCreature(*player, macro.target);
+            if (!vendor || !vendor->IsAlive()) return FinishMacro(bot, AI_MACRO_NO_TARGET);
+            AIMacroMoveResult move = ApproachTarget(player, macro, vendor, AI_MACRO_VENDOR_DISTANCE);
+            if (move == AI_MACRO_STUCK) return FinishMacro(bot, AI_MACRO_UNREACHABLE);
+            if (move == AI_MACRO_ARRIVED) {
+                macro.value = SellToVendor(player, bot.inventory, vendor);
+                return FinishMacro(bot, AI_MACRO_DONE);
+            }
+            break;
+        }
+        default:
+            macro.Clear();
+            break;
         }
     }
-};
-
-class AIControllerPlayerScript : public PlayerScript {
+    // Jeden Tick, aber nur Bots mit laufendem Makro kosten mehr als einen Vergleich
+    void UpdateMacros() {
+        uint32 now = getMSTime();
+        sAIBotRegistry->VisitOnline([&](AIBotEntry& bot) {
+            if (bot.macro.IsActive() && bot.player->IsInWorld()) UpdateMacro(bot, now);
+        });
+    }
+    static std::vector<std::string> SplitRoster(std::string const& roster) {
+        std::vector<std::string> names;
+        for (std::string_view name : Acore::Tokenize(roster, ',', false)) {
+            name = TrimSpaces(name);
+            if (!name.empty()) names.emplace_back(name);
+        }
+        return names;
+    }
+    // Auf Prozent von max gerundet, damit Regeneration nicht jeden Tick einen Snapshot auslöst
+    static uint64 QuantizePercent(uint32 value, uint32 max) {
+        return max ? uint64(value) * 100 / max : value;
+    }
+    // Billiger Fingerabdruck über Ziel, Kampfstatus, HP/Power (1%), Position (0.5 Yards) und
+    // Ziel-HP (1%) aller Player, ohne zu serialisieren
+    static uint64 ComputeWatchHash(std::vector<Player*> const& players) {
+        uint64 hash = players.size();
+        auto mix = [&hash](uint64 value) { hash = (hash ^ value) * 0x100000001B3ULL; };
+        for (Player* p : players) {
+            uint64 value = p->GetGUID().GetRawValue() ^ (p->GetTarget().GetRawValue() << 1);
+            if (p->IsInCombat()) value ^= 0x9E3779B97F4A7C15ULL;
+            if (p->HasUnitState(UNIT_STATE_CASTING)) value ^= 0xC2B2AE3D27D4EB4FULL;
+            mix(value);
+            Powers powerType = p->getPowerType();
+            mix(QuantizePercent(p->GetHealth(), p->GetMaxHealth()) | (QuantizePercent(p->GetPower(powerType), p->GetMaxPower(powerType)) << 32));
+            mix(uint64(uint32(int32(std::lround(p->GetPositionX() * 2.0f)))) | (uint64(uint32(int32(std::lround(p->GetPositionY() * 2.0f)))) << 32));
+            mix(uint64(uint32(int32(std::lround(p->GetPositionZ() * 2.0f)))));
+            if (Unit* target = p->GetSelectedUnit())
+                mix(QuantizePercent(target->GetHealth(), target->GetMaxHealth()));
+        }
+        return hash;
+    }
+    // Dasselbe für die Beobachtungen: nur was sich sprunghaft ändert (Auren, bereite Cooldowns,
+    // Cast, Ziel-HP, Threat-Reihenfolge), nicht die ablaufenden Restzeiten
+    static uint64 ComputeObservationHash(std::vector<AIPlayerObservation> const& observations) {
+        uint64 hash = observations.size();
+        auto mix = [&hash](uint64 value) { hash = (hash ^ value) * 0x100000001B3ULL; };
+        for (AIPlayerObservation const& o : observations) {
+            for (AIPlayerObservation::Aura const& aura : o.auras) mix(aura.spellId | (uint64(aura.stacks) << 32));
+            for (uint8 i = 0; i < o.cooldownCount; ++i) mix(o.cooldowns[i] == 0);
+            mix(o.castSpell);
+            mix(o.targetHp | (uint64(o.targetLevel) << 32));
+            for (AIPlayerObservation::Threat const& threat : o.threat) mix(uint64(uint32(threat.mobIndex)) | (uint64(threat.entry) << 32) | threat.attackingMe);
+        }
+        return hash;
+    }
 public:
-    AIControllerPlayerScript() : PlayerScript("AIControllerPlayerScript") {}
+    AIControllerWorldScript() : WorldScript("AIControllerWorldScript"), _fastTimer(0), _faceTimer(0), _faceCarry(0), _faceCursor(0),
+        _stateInterval(400), _faceInterval(150), _faceSpread(false), _stateOnChange(false), _watchHash(0),
+        _observationFields(0), _observationHash(0), _macroTimeout(60000) {}
+    void OnAfterConfigLoad(bool reload) override {
+        _stateInterval = sConfigMgr->GetOption<uint32>("AIController.State.Interval", 400);
+        _stateOnChange = sConfigMgr->GetOption<bool>("AIController.State.OnChange", false);
+        _faceInterval = sConfigMgr->GetOption<uint32>("AIController.Facing.Interval", 150);
+        _faceSpread = sConfigMgr->GetOption<bool>("AIController.Facing.Spread", false);
+        _observedPlayers = SplitRoster(sConfigMgr->GetOption<std::string>("AIController.State.ObservedPlayers", ""));
+        _macroTimeout = sConfigMgr->GetOption<uint32>("AIController.Macro.Timeout", 60000);
+        sAIMetrics->SetEnabled(sConfigMgr->GetOption<bool>("AIController.Metrics.Enable", false));
+        sAITrajectory->Configure(sConfigMgr->GetOption<bool>("AIController.Record.Enable", false),
+            sConfigMgr->GetOption<std::string>("AIController.Record.Directory", "trajectories"),
+            uint64(sConfigMgr->GetOption<uint32>("AIController.Record.SegmentSize", 256)) * 1024 * 1024);
+        _perception.SetScanInterval(sConfigMgr->GetOption<uint32>("AIController.Perception.ScanInterval", 2000));
+        sAIServer->SetKeepAliveInterval(sConfigMgr->GetOption<uint32>("AIController.KeepAliveInterval", 500));
+        sAIServer->SetKeyframeInterval(sConfigMgr->GetOption<uint32>("AIController.Delta.KeyframeInterval", 25));
+        g_CommandQueue.SetCapacity(sConfigMgr->GetOption<uint32>("AIController.CommandQueue.Capacity", 4096));
+        sAIBotSpawner->SetRoster(SplitRoster(sConfigMgr->GetOption<std::string>("AIController.Spawn.Roster", "Bota,Botb,Botc,Botd,Bote")));
+        sAIBotSpawner->SetMaxPendingLoads(sConfigMgr->GetOption<uint32>("AIController.Spawn.MaxPendingLoads", 50));
+        sAIBotSpawner->SetMaxFinalizePerTick(sConfigMgr->GetOption<uint32>("AIController.Spawn.MaxFinalizePerTick", 5));
+        uint32 loginProfile = sConfigMgr->GetOption<uint32>("AIController.Login.Profile", AI_LOGIN_PROFILE_FULL);
+        sAIBotSpawner->SetLoginProfile(loginProfile < MAX_AI_LOGIN_PROFILE ? AIBotLoginProfile(loginProfile) : AI_LOGIN_PROFILE_FULL);
+        sAIBotSpawner->SetTemplates(sConfigMgr->GetOption<std::string>("AIController.Login.Templates", ""));
+        g_LootRewardByScore = sConfigMgr->GetOption<bool>("AIController.ItemScore.LootReward", false);
+        sAIItemScore->LoadWeights();
+        _observation.LoadSpells();
+        if (reload) {
+            // Beim Start sind die ItemTemplates noch nicht geladen, dann baut OnStartup die Tabelle
+            sAIItemScore->Build();
+            sAIBotRegistry->VisitOnline([](AIBotEntry& bot) { bot.inventory.MarkDirty(); });
+        }
+        MarkStateDirty();
+        if (reload)
+            LOG_INFO("module", "AI-CONTROLLER: Konfiguration neu geladen (Port und Netzwerk-Threads erst nach Neustart).");
+    }
+    void OnStartup() override {
+        uint16 port = sConfigMgr->GetOption<uint16>("AIController.Port", 5000);
+        uint32 threads = sConfigMgr->GetOption<uint32>("AIController.NetworkThreads", 2);
+        sAIItemScore->Build();
+        sAIServer->PublishRoster(_roster);
+        sAIServer->Start(port, threads);
+    }
+    void OnShutdown() override {
+        sAIServer->Stop();
+        sAITrajectory->Stop();
+    }
 
-    void OnPlayerBeforeSendChatMessage(Player* player, uint32& type, uint32& lang, std::string& msg) override {
-        std::string commandPrefix = "#spawn";
-        std::string commandSpawnAll = "#spawnbots";
+    void OnUpdate(uint32 diff) override {
+        AIMetricTimer tickTimer(AI_HIST_TICK);
+        _fastTimer += diff;
 
-        auto spawnBotByName = [player, &msg](std::string const& botName) -> bool {
-            if (botName.empty()) {
-                ChatHandler(player->GetSession()).SendSysMessage("Bot-Name fehlt.");
-                return false;
-            }
+        UpdateFacing(diff);
 
-            if (ObjectAccessor::FindPlayerByName(botName)) {
-                ChatHandler(player->GetSession()).SendSysMessage("Bot ist bereits online.");
-                return false;
-            }
+        // Bot-Logins: DB-Loads asynchron, begrenzt viele Bots pro Tick in die Welt
+        {
+            AIMetricTimer timer(AI_HIST_SPAWNER);
+            sAIBotSpawner->Update();
+        }
 
-            LOG_INFO("module", "AI-DEBUG: Versuche Bot zu spawnen: '{}'", botName);
+        // Handles an die Clients, sobald Bots ein- oder ausgeloggt sind
+        if (sAIBotRegistry->ConsumeRosterChanged()) {
+            MarkStateDirty();
+            sAIBotRegistry->BuildRoster(_roster);
+            sAIServer->PublishRoster(_roster);
+        }
 
-            // ACHTUNG: Hier muss sCharacterCache evtl. durch eine entsprechende Methode in Ihrem Core ersetzt werden,
-            // falls GetCharacterGuidByName dort anders heißt.
-            ObjectGuid guid = sCharacterCache->GetCharacterGuidByName(botName);
-            if (!guid) {
-                ChatHandler(player->GetSession()).SendSysMessage("Charakter nicht gefunden.");
-                return false;
-            }
+        // Grid-Scans verteilt über alle Ticks statt alle 2s auf einen Schlag
+        {
+            AIMetricTimer timer(AI_HIST_PERCEPTION);
+            _perception.Update(diff);
+        }
 
-            LOG_INFO("module", "DEBUG STEP 1: Hole AccountID...");
-            uint32 accountId = sCharacterCache->GetCharacterAccountIdByGuid(guid);
-            LOG_INFO("module", "DEBUG STEP 2: AccountID ist {}", accountId);
+        ApplyCommands();
 
-            if (accountId == 0) {
-                ChatHandler(player->GetSession()).SendSysMessage("Fehler: Ungültige AccountID.");
-                return false;
-            }
+        // Makros führen ihre Schritte selbst aus, der Client wartet nur auf das Event
+        {
+            AIMetricTimer timer(AI_HIST_MACROS);
+            UpdateMacros();
+        }
 
-            if (sWorldSessionMgr->FindSession(accountId)) {
-                LOG_ERROR("module", "ABORT: Account {} ist bereits eingeloggt!", accountId);
-                ChatHandler(player->GetSession()).SendSysMessage("Fehler: Account bereits eingeloggt.");
-                return false;
-            }
+        // Nach einem Step, Reset oder Makro-Ende sofort, damit Lock-Step-Clients nicht auf den Timer warten
+        if (_fastTimer >= _stateInterval || !_appliedSteps.empty() || !_episodes.empty() || !_macroEvents.empty())
+            PublishSnapshot();
+    }
+    void ApplyCommands() {
+        AIMetricTimer timer(AI_HIST_COMMANDS);
+
+        // Queue in O(1) übernehmen, danach läuft die Weltlogik ohne Lock
+        _commandBatch.clear();
+        g_CommandQueue.TakeAll(_commandBatch);
+        if (uint32 dropped = g_CommandQueue.ConsumeDropped()) {
+            LOG_ERROR("module", "AI-SOCKET: Command-Queue voll, {} Kommandos verworfen.", dropped);
+            sAIMetrics->Add(AI_COUNTER_DROPPED, dropped);
+        }
 
-            {
-                std::lock_guard<std::mutex> lock(g_BotSessionsMutex);
-                if (g_BotSessions.find(accountId) != g_BotSessions.end()) {
-                    LOG_ERROR("module", "ABORT: Bot-Session für Account {} existiert bereits.", accountId);
-                    ChatHandler(player->GetSession()).SendSysMessage("Fehler: Bot bereits aktiv.");
-                    return false;
+        if (sAIMetrics->IsEnabled()) {
+            sAIMetrics->Record(AI_HIST_BATCH_SIZE, _commandBatch.size());
+            sAIMetrics->Add(AI_COUNTER_COMMANDS, _commandBatch.size());
+            // Eine Uhr-Abfrage pro Tick; Kommandos von vor dem Enable haben keinen Zeitstempel
+            auto now = std::chrono::steady_clock::now();
+            for (AICommand const& cmd : _commandBatch)
+                if (cmd.receivedAt.time_since_epoch().count())
+                    sAIMetrics->Record(AI_HIST_COMMAND_LATENCY, uint64(std::chrono::duration_cast<std::chrono::microseconds>(now - cmd.receivedAt).count()));
+        }
+
+        for (AICommand const& cmd : _commandBatch) {
+            if (cmd.action == AI_ACTION_SPAWN) {
+                if (cmd.playerGuid) sAIBotSpawner->Enqueue(ObjectGuid(cmd.playerGuid));
+                else sAIBotSpawner->Enqueue(cmd.playerName);
+                if (sAITrajectory->IsEnabled()) {
+                    // Der Bot bekommt sein Handle erst beim Login; die GUID steht schon fest
+                    ObjectGuid guid = cmd.playerGuid ? ObjectGuid(cmd.playerGuid) : sCharacterCache->GetCharacterGuidByName(cmd.playerName);
+                    AIBotEntry* bot = guid ? sAIBotRegistry->FindByGuid(guid) : nullptr;
+                    sAITrajectory->RecordCommand(cmd, guid.GetRawValue(), bot ? bot->index : AI_INVALID_BOT_HANDLE);
                 }
+                continue;
             }
-
-            // --- ASYNCHRONE LADESTRATEGIE (Core-Login-Flow) ---
-            LOG_INFO("module", "DEBUG STEP 3: Starte asynchronen Login...");
-
-            // 1. Session erstellen (IsBot simuliert durch Flags oder manuelles Handling, da Konstruktor nur 12 Args hat)
-            WorldSession* botSession = new WorldSession(
-                accountId,
-                std::string(botName),
-                0,      // Security Token (dummy)
-                nullptr,// Socket (dummy)
-                SEC_PLAYER,
-                EXPANSION_WRATH_OF_THE_LICH_KING,
-                time_t(0),
-                LOCALE_enUS,
-                0,
-                false,
-                true,   // skipQueue = true
-                0
-            );
-
-            // 2. Holder erstellen
-            auto holder = std::make_shared<BotLoginQueryHolder>(accountId, guid);
-
-            // 3. Initialisieren (nur PreparedStatements setzen)
-            if (!holder->Initialize()) {
-                LOG_ERROR("module", "FAIL: Konnte LoginQueryHolder nicht initialisieren.");
-                ChatHandler(player->GetSession()).SendSysMessage("Interner DB-Fehler (Init).");
-                delete botSession;
-                return false;
+            // Step-Marker: alle Kommandos des Steps liegen davor im selben Batch
+            if (cmd.action == AI_ACTION_NONE) {
+                if (cmd.stepId) {
+                    _appliedSteps.push_back({ cmd.sessionId, cmd.stepId });
+                    sAITrajectory->RecordCommand(cmd, 0, AI_INVALID_BOT_HANDLE);
+                }
+                continue;
             }
+            if (cmd.action == AI_ACTION_RESET || cmd.action == AI_ACTION_RESET_BATCH || cmd.action == AI_ACTION_CHECKPOINT) {
+                HandleEpisodeCommand(cmd);
+                continue;
+            }
+            AIBotEntry* bot = ResolveBot(cmd);
+            Player* player = bot ? bot->player : nullptr;
+            if (!player || !player->IsInWorld()) continue;
+            sAITrajectory->RecordCommand(cmd, player->GetGUID().GetRawValue(), bot->index);
+            if (IsMacroAction(cmd.action)) {
+                StartMacro(*bot, cmd);
+                continue;
+            }
+            if (bot->macro.IsActive() && CancelsMacro(cmd.action)) FinishMacro(*bot, AI_MACRO_CANCELLED);
+            ExecuteCommand(player, bot->inventory, cmd);
+            MarkStateDirty();
+        }
+        sAITrajectory->FlushCommands(g_StateVersion.load(std::memory_order_relaxed), GameTime::GetGameTimeMS().count());
+    }
+    void PublishSnapshot() {
+        AIMetricTimer timer(AI_HIST_SNAPSHOT);
+        _fastTimer = 0;
+        _snapshotPlayers.clear();
+        CollectSnapshotPlayers(_snapshotPlayers);
+
+        // On-Change: ohne Event, Kommando, Ziel-/Kampfwechsel oder neue Mobs wird gar nicht serialisiert
+        bool changed = g_StateDirty.exchange(false, std::memory_order_relaxed);
+        changed |= _perception.ConsumeChanged();
+        uint64 watchHash = ComputeWatchHash(_snapshotPlayers);
+        changed |= watchHash != _watchHash;
+        _watchHash = watchHash;
+
+        // Beobachtungen nur, solange ein Client sie abonniert hat; ein neues Abo braucht sofort einen Snapshot
+        uint32 observationFields = sAIServer->GetObservationFields();
+        changed |= observationFields != _observationFields;
+        _observationFields = observationFields;
+        _observations.clear();
+        if (observationFields) {
+            AIMetricTimer observationTimer(AI_HIST_OBSERVATION);
+            _observations.resize(_snapshotPlayers.size());
+            for (std::size_t i = 0; i < _snapshotPlayers.size(); ++i)
+                if (Player* p = _snapshotPlayers[i])
+                    _observation.Collect(p, observationFields, _perception.Get(p->GetGUID().GetRawValue()), _observations[i]);
+            uint64 observationHash = ComputeObservationHash(_observations);
+            changed |= observationHash != _observationHash;
+            _observationHash = observationHash;
+        }
+        _observation.Prune(observationFields);
+        if (_stateOnChange && !changed && _appliedSteps.empty() && _episodes.empty() && _macroEvents.empty()) {
+            _perception.SetBots(_snapshotPlayers);
+            return;
+        }
 
-            LOG_INFO("module", "DEBUG STEP 4: DB-Queries gestartet...");
-
-            {
-                std::lock_guard<std::mutex> lock(g_BotSessionsMutex);
-                g_BotSessions[accountId] = botSession;
+        _stateBuilder.Begin(observationFields);
+        for (AIStepAck const& step : _appliedSteps)
+            _stateBuilder.AddStep(step);
+        _appliedSteps.clear();
+        for (AIEpisodeEvent const& episode : _episodes)
+            _stateBuilder.AddEpisode(episode);
+        _episodes.clear();
+        for (AIMacroEvent const& macro : _macroEvents)
+            _stateBuilder.AddMacro(macro);
+        _macroEvents.clear();
+        for (std::size_t i = 0; i < _snapshotPlayers.size(); ++i) {
+            Player* p = _snapshotPlayers[i];
+            if (!p) continue;
+            AIPlayerRecord rec;
+            rec.guid = p->GetGUID().GetRawValue();
+            if (AIBotTag const* tag = AIBotRegistry::GetTag(p)) rec.handle = tag->index;
+            rec.hp = p->GetHealth();
+            rec.maxHp = p->GetMaxHealth();
+            rec.power = p->GetPower(p->getPowerType());
+            rec.maxPower = p->GetMaxPower(p->getPowerType());
+            rec.level = p->GetLevel();
+            rec.x = p->GetPositionX(); rec.y = p->GetPositionY(); rec.z = p->GetPositionZ(); rec.o = p->GetOrientation();
+            if (p->IsInCombat()) rec.flags |= AI_PLAYER_FLAG_COMBAT;
+            if (p->HasUnitState(UNIT_STATE_CASTING)) rec.flags |= AI_PLAYER_FLAG_CASTING;
+            AIInventorySummary* inventory = AIBotRegistry::GetInventory(p);
+            rec.freeSlots = inventory ? inventory->GetFreeSlots(p) : CountFreeBagSlots(p);
+            if (AIBotEvents* events = AIBotRegistry::GetEvents(p)) events->ConsumeInto(rec);
+            if (Unit* target = p->GetSelectedUnit()) {
+                rec.targetStatus = target->IsAlive() ? AI_TARGET_ALIVE : AI_TARGET_DEAD;
+                rec.targetHp = target->GetHealth();
+                rec.tx = target->GetPositionX(); rec.ty = target->GetPositionY(); rec.tz = target->GetPositionZ();
             }
+            static std::vector<AIMobRecord> const noMobs;
+            AIBotPerception const* perception = _perception.Get(rec.guid);
+            AIPlayerObservation const* observation = observationFields ? &_observations[i] : nullptr;
+            if (perception)
+                _stateBuilder.AddPlayer(p->GetName(), rec, perception->mobsJson, perception->mobs, observation);
+            else
+                _stateBuilder.AddPlayer(p->GetName(), rec, "[]", noMobs, observation);
+        }
+        _perception.SetBots(_snapshotPlayers);
+        // Nur Pointer tauschen; der alte Snapshot wird außerhalb des Locks losgelassen
+        AIStateSnapshotPtr snapshot = _stateBuilder.Finish(g_StateVersion.load(std::memory_order_relaxed) + 1);
+        sAITrajectory->RecordState(snapshot, GameTime::GetGameTimeMS().count());
+        AIStateSnapshotPtr previous = snapshot;
+        { std::lock_guard<std::mutex> lock(g_StateMutex); g_CurrentState.swap(previous); }
+        previous.reset();
+        g_StateVersion.fetch_add(1, std::memory_order_release);
+        // Jeder Snapshot geht selbst raus, auch wenn schon der nächste veröffentlicht ist: nur er trägt seine Acks
+        sAIServer->NotifyStateChanged(std::move(snapshot));
+        sAIMetrics->Add(AI_COUNTER_SNAPSHOTS);
+    }
+};
 
-            g_QueryHolderProcessor.AddCallback(CharacterDatabase.DelayQueryHolder(holder)).AfterComplete(
-                [accountId, guid, botName](SQLQueryHolderBase const& holderBase)
-                {
-                    WorldSession* session = nullptr;
-                    {
-                        std::lock_guard<std::mutex> lock(g_BotSessionsMutex);
-                        auto it = g_BotSessions.find(accountId);
-                        if (it != g_BotSessions.end())
-                            session = it->second;
-                    }
-                    if (!session)
-                    {
-                        LOG_ERROR("module", "Bot-Login: Session für Account {} nicht gefunden.", accountId);
-                        return;
-                    }
-
-                    auto const& typedHolder = static_cast<BotLoginQueryHolder const&>(holderBase);
-                    Player* botPlayer = new Player(session);
-
-                    if (!botPlayer->LoadFromDB(guid, typedHolder))
-                    {
-                        LOG_ERROR("module", "FAIL: Player konnte nicht geladen werden.");
-                        delete botPlayer;
-                        std::lock_guard<std::mutex> lock(g_BotSessionsMutex);
-                        auto it = g_BotSessions.find(accountId);
-                        if (it != g_BotSessions.end())
-                        {
-                            delete it->second;
-                            g_BotSessions.erase(it);
-                        }
-                        return;
-                    }
-
-                    LOG_INFO("module", "DEBUG STEP 5: Player geladen: {}", botPlayer->GetName());
-
-                    session->SetPlayer(botPlayer);
-
-                    botPlayer->GetMotionMaster()->Initialize();
-                    botPlayer->SendInitialPacketsBeforeAddToMap();
-
-                    ObjectAccessor::AddObject(botPlayer);
-
-                    if (!botPlayer->GetMap()->AddPlayerToMap(botPlayer) || !botPlayer->CheckInstanceLoginValid())
-                    {
-                        AreaTriggerTeleport const* at = sObjectMgr->GetGoBackTrigger(botPlayer->GetMapId());
-                        if (at)
-                        {
-                            botPlayer->TeleportTo(at->target_mapId, at->target_X, at->target_Y, at->target_Z, botPlayer->GetOrientation());
-                        }
-                        else
-                        {
-                            botPlayer->TeleportTo(botPlayer->m_homebindMapId, botPlayer->m_homebindX, botPlayer->m_homebindY, botPlayer->m_homebindZ, botPlayer->GetOrientation());
-                        }
-
-                        botPlayer->GetSession()->SendNameQueryOpcode(botPlayer->GetGUID());
-                    }
-
-                    botPlayer->SendInitialPacketsAfterAddToMap();
-
-                    CharacterDatabasePreparedStatement* onlineStmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_CHAR_ONLINE);
-                    onlineStmt->SetData(0, botPlayer->GetGUID().GetCounter());
-                    CharacterDatabase.Execute(onlineStmt);
-
-                    constexpr uint32 kSpawnMapId = 0;
-                    constexpr float kSpawnX = -8921.037f;
-                    constexpr float kSpawnY = -120.484985f;
-                    constexpr float kSpawnZ = 82.02542f;
-                    constexpr float kSpawnO = 3.299f;
-
-                    botPlayer->TeleportTo(kSpawnMapId, kSpawnX, kSpawnY, kSpawnZ, kSpawnO);
-
-                    LOG_INFO("module", "DEBUG STEP 6: Bot '{}' erfolgreich gespawnt.", botName);
-                });
+class AIControllerPlayerScript : public PlayerScript {
+public:
+    AIControllerPlayerScript() : PlayerScript("AIControllerPlayerScript") {}
 
-            msg = "";
-            return true;
-            };
+    void OnPlayerBeforeSendChatMessage(Player* player, uint32& type, uint32& lang, std::string& msg) override {
+        std::string commandPrefix = "#spawn";
+        std::string commandSpawnAll = "#spawnbots";
 
+        // #spawnbots           -> AIController.Spawn.Roster
+        // #spawnbots <a>-<b>   -> je ein Charakter der Accounts a bis b
         if (msg.length() >= commandSpawnAll.length() && msg.substr(0, commandSpawnAll.length()) == commandSpawnAll) {
             LOG_INFO("module", "AI-DEBUG: Chat von {}: '{}'", player->GetName(), msg);
-            std::vector<std::string> botNames = { "Bota", "Botb", "Botc", "Botd", "Bote" };
-            for (std::string const& botName : botNames) {
-                spawnBotByName(botName);
+            std::string range = msg.substr(commandSpawnAll.length());
+            uint32 firstAccount = 0, lastAccount = 0;
+            if (sscanf(range.c_str(), " %u-%u", &firstAccount, &lastAccount) == 2) {
+                sAIBotSpawner->EnqueueAccountRange(firstAccount, lastAccount, player->GetGUID());
+                ChatHandler(player->GetSession()).PSendSysMessage("Spawne Bots der Accounts {}-{}...", firstAccount, lastAccount);
+            } else {
+                sAIBotSpawner->EnqueueRoster(player->GetGUID());
+                ChatHandler(player->GetSession()).SendSysMessage("Spawne Bots aus AIController.Spawn.Roster...");
             }
             msg = "";
             return;
@@ -983,13 +922,28 @@ public:
             std::string botName = msg.substr(commandPrefix.length() + 1);
             if (!botName.empty() && botName.back() == ' ') botName.pop_back();
 
-            spawnBotByName(botName);
+            sAIBotSpawner->Enqueue(botName, player->GetGUID());
+            msg = "";
         }
     }
+    void OnPlayerLogout(Player* player) override {
+        sAIBotRegistry->UnbindPlayer(player);
+    }
+    void OnPlayerStoreNewItem(Player* player, Item* /*item*/, uint32 /*count*/) override {
+        MarkInventoryChanged(player);
+    }
+    void OnPlayerEquip(Player* player, Item* /*it*/, uint8 /*bag*/, uint8 /*slot*/, bool /*update*/) override {
+        MarkInventoryChanged(player);
+    }
+    void OnPlayerAfterMoveItemFromInventory(Player* player, Item* /*it*/, uint8 /*bag*/, uint8 /*slot*/, bool /*update*/) override {
+        MarkInventoryChanged(player);
+    }
     void OnPlayerGiveXP(Player* player, uint32& amount, Unit* victim, uint8 xpSource) override {
         AddXPGained(player, amount);
     }
     void OnPlayerLevelChanged(Player* player, uint8 oldLevel) override {
+        // Nur Bots werden auf Level 1 gehalten, Spieler leveln normal
+        if (!AIBotRegistry::GetTag(player)) return;
         if (player->GetLevel() >= 2) {
             SetLeveledUp(player);
             player->SetLevel(1); player->SetUInt32Value(PLAYER_XP, 0); player->InitStatsForLevel(true);
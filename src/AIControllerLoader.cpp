@@ -7,8 +7,10 @@
 
 // Forward declaration der Funktion, die wir gleich in der anderen Datei schreiben
 void AddAIControllerScripts();
+void AddAIControllerCommandScripts();
 
 // Diese Funktion wird vom Server beim Start automatisch aufgerufen
 void Addmod_ai_controllerScripts() {
     AddAIControllerScripts();
+    AddAIControllerCommandScripts();
 }
\ No newline at end of file
@@ -0,0 +1,836 @@
+#include "AIControllerServer.h"
+#include "AIController.h"
+#include "AIMetrics.h"
+#include "AIProtocol.h"
+#include "Log.h"
+#include <algorithm>
+#include <charconv>
+
+using boost::asio::ip::tcp;
+
+// --- CLIENT SESSION ---
+//
+// Alle Handler einer Session laufen auf demselben Strand (Executor des Sockets),
+// daher braucht die Session selbst keine Locks.
+//
+AIClientSession::AIClientSession(tcp::socket&& socket, AIControllerServer& server)
+    : _socket(std::move(socket)), _server(server), _id(server.NextSessionId()), _keepAliveTimer(_socket.get_executor()),
+      _readBuffer(), _mode(AI_STREAM_FULL), _deltasSinceKeyframe(0), _rosterSubscribed(false),
+      _stepOpen(false), _stepOverflow(false), _stepId(0), _lastAckVersion(0),
+      _lastSend(std::chrono::steady_clock::now()), _closed(false), _bytesSent(0), _framesSent(0)
+{
+}
+
+AIClientSession::~AIClientSession()
+{
+    if (_subscription)
+        _server.ReleaseObservationFields(_subscription->GetFields());
+}
+
+void AIClientSession::Start()
+{
+    LOG_INFO("module", ">>> CLIENT VERBUNDEN! <<<");
+
+    // optional: kleine Latenz-Optimierung
+    boost::system::error_code ec;
+    _socket.set_option(tcp::no_delay(true), ec);
+
+    boost::asio::dispatch(_socket.get_executor(), [self = shared_from_this()]()
+    {
+        // Initial-State sofort senden
+        self->_delivered = self->_server.GetLatestState();
+        self->SendState(self->_delivered);
+        self->ScheduleKeepAlive();
+        self->DoRead();
+    });
+}
+
+void AIClientSession::Close()
+{
+    if (_closed)
+        return;
+
+    _closed = true;
+    _keepAliveTimer.cancel();
+
+    boost::system::error_code ec;
+    _socket.shutdown(tcp::socket::shutdown_both, ec);
+    _socket.close(ec);
+
+    LOG_INFO("module", ">>> CLIENT GETRENNT <<<");
+}
+
+void AIClientSession::QueueState(AIStateSnapshotPtr state)
+{
+    boost::asio::post(_socket.get_executor(), [self = shared_from_this(), state = std::move(state)]()
+    {
+        // Beim Connect kann der neueste Snapshot schon vor seinem Broadcast angekommen sein
+        if (self->_delivered && state->version <= self->_delivered->version)
+            return;
+        self->_delivered = state;
+        self->SendState(state);
+    });
+}
+
+void AIClientSession::QueueRoster()
+{
+    boost::asio::post(_socket.get_executor(), [self = shared_from_this()]()
+    {
+        self->SendRoster();
+    });
+}
+
+void AIClientSession::SendRoster()
+{
+    if (!_rosterSubscribed)
+        return;
+
+    if (FramePtr frame = _server.GetRosterFrame(_mode == AI_STREAM_BINARY))
+        SendFrame(std::move(frame));
+}
+
+void AIClientSession::SendState(AIStateSnapshotPtr state)
+{
+    if (_closed || !state)
+        return;
+
+    // Eigene Steps, Resets und Makros bestätigen; Control-Frames gehen vor dem State raus
+    if (state->version > _lastAckVersion)
+    {
+        _lastAckVersion = state->version;
+        for (AIStepAck const& ack : state->steps)
+            if (ack.session == _id)
+                SendFrame(MakeStepAck(ack.step, state->version, AI_STEP_APPLIED));
+        for (AIEpisodeEvent const& episode : state->episodes)
+            if (episode.session == _id)
+                SendFrame(MakeEpisodeEvent(episode, state->version));
+        for (AIMacroEvent const& macro : state->macros)
+            if (macro.session == _id)
+                SendFrame(MakeMacroEvent(macro, state->version));
+    }
+
+    _pending = std::move(state);
+    if (!_writing)
+        WriteNext();
+}
+
+AIClientSession::FramePtr AIClientSession::EncodeState(AIStateSnapshotPtr const& state)
+{
+    AISubscription const* subscription = _subscription.get();
+
+    if (_mode == AI_STREAM_FULL)
+        return subscription ? _server.GetFullFrame(state, *subscription) : FramePtr(state, &state->json);
+
+    if (_mode == AI_STREAM_BINARY)
+        return _server.GetBinaryFrame(state, subscription);
+
+    uint32 interval = _server.GetKeyframeInterval();
+    if (!_sent || (interval && _deltasSinceKeyframe >= interval))
+    {
+        _deltasSinceKeyframe = 0;
+        return _server.GetKeyframe(state, subscription);
+    }
+
+    ++_deltasSinceKeyframe;
+    return _server.GetDeltaFrame(_sent, state, subscription);
+}
+
+void AIClientSession::SendMetrics()
+{
+    std::string report = _server.BuildMetricsReport();
+    if (_mode == AI_STREAM_BINARY)
+        SendFrame(std::make_shared<std::string const>(EncodeBinaryMetrics(report)));
+    else
+        SendFrame(std::make_shared<std::string const>(BuildMetricsFrame(report)));
+}
+
+void AIClientSession::SetSubscription(std::shared_ptr<AISubscription const> subscription)
+{
+    // "Alles" braucht keinen eigenen Cache-Eintrag, im Full-Modus bleibt es beim Dokument ohne Kopie
+    if (subscription && subscription->IsAll())
+        subscription.reset();
+
+    // Erst die neuen Felder anmelden, damit ein weiter abonniertes Feld nicht kurz auf 0 fällt
+    if (subscription)
+        _server.RetainObservationFields(subscription->GetFields());
+    if (_subscription)
+        _server.ReleaseObservationFields(_subscription->GetFields());
+    _subscription = std::move(subscription);
+
+    // Das letzte Frame hatte eine andere Auswahl, also keine Delta-Basis mehr
+    _sent.reset();
+    SendState(_delivered);
+}
+
+void AIClientSession::SendFrame(FramePtr frame)
+{
+    if (_closed)
+        return;
+
+    _controlFrames.push_back(std::move(frame));
+    if (!_writing)
+        WriteNext();
+}
+
+void AIClientSession::WriteNext()
+{
+    if (_closed)
+        return;
+
+    if (!_controlFrames.empty())
+    {
+        _writing = std::move(_controlFrames.front());
+        _controlFrames.pop_front();
+        DoWrite();
+        return;
+    }
+
+    if (!_pending)
+        return;
+
+    AIStateSnapshotPtr state = std::move(_pending);
+    _pending.reset();
+
+    _writing = EncodeState(state);
+    _sent = std::move(state);
+    DoWrite();
+}
+
+void AIClientSession::DoWrite()
+{
+    boost::asio::async_write(_socket, boost::asio::buffer(*_writing),
+        [self = shared_from_this()](boost::system::error_code const& error, std::size_t length)
+        {
+            if (error)
+            {
+                if (error != boost::asio::error::operation_aborted)
+                    LOG_ERROR("module", "Verbindung verloren: {}", error.message());
+                self->Close();
+                return;
+            }
+
+            if (sAIMetrics->IsEnabled())
+            {
+                self->_bytesSent.fetch_add(length, std::memory_order_relaxed);
+                self->_framesSent.fetch_add(1, std::memory_order_relaxed);
+                sAIMetrics->Add(AI_COUNTER_BYTES_SENT, length);
+                sAIMetrics->Add(AI_COUNTER_FRAMES_SENT);
+            }
+
+            self->_lastSend = std::chrono::steady_clock::now();
+            self->_writing.reset();
+            self->WriteNext();
+        });
+}
+
+void AIClientSession::ScheduleKeepAlive()
+{
+    // 0 = aus; der Timer läuft trotzdem weiter, damit ein Reload wirkt
+    uint32 intervalMs = _server.GetKeepAliveInterval();
+    std::chrono::milliseconds interval(intervalMs ? intervalMs : 1000);
+
+    _keepAliveTimer.expires_after(interval);
+    _keepAliveTimer.async_wait([self = shared_from_this(), interval, enabled = intervalMs != 0](boost::system::error_code const& error)
+    {
+        if (error || self->_closed)
+            return;
+
+        // Keepalive nur, wenn seit einem Intervall nichts rausging
+        if (enabled && !self->_writing && std::chrono::steady_clock::now() - self->_lastSend >= interval)
+        {
+            if (self->_mode == AI_STREAM_DELTA && self->_sent)
+            {
+                // Im Delta-Modus reicht ein winziger Heartbeat
+                self->SendFrame(std::make_shared<std::string const>(BuildHeartbeat(self->_sent->version)));
+            }
+            else if (self->_mode == AI_STREAM_BINARY && self->_sent)
+                self->SendFrame(std::make_shared<std::string const>(EncodeBinaryHeartbeat(self->_sent->version)));
+            else
+                self->SendState(self->_delivered);
+        }
+
+        self->ScheduleKeepAlive();
+    });
+}
+
+void AIClientSession::DoRead()
+{
+    _socket.async_read_some(boost::asio::buffer(_readBuffer),
+        [self = shared_from_this()](boost::system::error_code const& error, std::size_t length)
+        {
+            if (error)
+            {
+                if (error != boost::asio::error::eof && error != boost::asio::error::operation_aborted)
+                    LOG_ERROR("module", "Verbindung verloren: {}", error.message());
+                self->Close();
+                return;
+            }
+
+            self->_incomingBuffer.append(self->_readBuffer.data(), length);
+            self->ProcessIncoming();
+
+            if (!self->_closed)
+                self->DoRead();
+        });
+}
+
+// Commands sofort beim Eintreffen weiterreichen
+void AIClientSession::ProcessIncoming()
+{
+    std::size_t consumed = 0;
+    while (_mode != AI_STREAM_BINARY)
+    {
+        std::size_t newlinePos = _incomingBuffer.find('\n', consumed);
+        if (newlinePos == std::string::npos)
+            break;
+
+        std::string line = _incomingBuffer.substr(consumed, newlinePos - consumed);
+        consumed = newlinePos + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+
+        if (line[0] == '@')
+            HandleControl(line);
+        else
+            HandleLine(line);
+    }
+    _incomingBuffer.erase(0, consumed);
+
+    if (_mode != AI_STREAM_BINARY && _incomingBuffer.size() > AI_MAX_CLIENT_FRAME_SIZE)
+    {
+        LOG_ERROR("module", "AI-SOCKET: Zeile ohne Zeilenende zu lang, trenne Verbindung.");
+        Close();
+        return;
+    }
+
+    // Nach "@binary" ist der Rest des Puffers bereits binär
+    if (_mode == AI_STREAM_BINARY && !ProcessBinaryFrames())
+    {
+        LOG_ERROR("module", "AI-SOCKET: Ungültiger Binär-Frame, trenne Verbindung.");
+        Close();
+    }
+}
+
+bool AIClientSession::ProcessBinaryFrames()
+{
+    std::size_t consumed = 0;
+    while (_incomingBuffer.size() - consumed >= AI_FRAME_HEADER_SIZE)
+    {
+        AIByteReader header(_incomingBuffer.data() + consumed, AI_FRAME_HEADER_SIZE);
+        uint32 frameLength = header.U32();
+        if (frameLength == 0 || frameLength > AI_MAX_CLIENT_FRAME_SIZE)
+            return false;
+
+        if (_incomingBuffer.size() - consumed < AI_FRAME_HEADER_SIZE + frameLength)
+            break;
+
+        char const* frame = _incomingBuffer.data() + consumed + AI_FRAME_HEADER_SIZE;
+        consumed += AI_FRAME_HEADER_SIZE + frameLength;
+
+        AIFrameType type = AIFrameType(uint8(frame[0]));
+        switch (type)
+        {
+            case AI_FRAME_COMMAND:
+            case AI_FRAME_BOT_COMMAND:
+            {
+                AICommand cmd;
+                if (!DecodeBinaryCommand(type, frame + 1, frameLength - 1, cmd))
+                {
+                    LOG_ERROR("module", "AI-SOCKET: Ungültiges Binär-Kommando verworfen.");
+                    continue;
+                }
+                QueueCommand(std::move(cmd));
+                break;
+            }
+            case AI_FRAME_STEP_BEGIN:
+            {
+                AIByteReader reader(frame + 1, frameLength - 1);
+                uint64 stepId = reader.U64();
+                if (reader.HasError() || !stepId)
+                    return false;
+                BeginStep(stepId);
+                break;
+            }
+            case AI_FRAME_STEP_END:
+                EndStep();
+                break;
+            case AI_FRAME_METRICS:
+                SendMetrics();
+                break;
+            case AI_FRAME_SUBSCRIBE:
+            {
+                auto subscription = std::make_shared<AISubscription>();
+                if (!DecodeBinarySubscription(frame + 1, frameLength - 1, *subscription))
+                {
+                    LOG_ERROR("module", "AI-SOCKET: Ungültige Subscription verworfen.");
+                    continue;
+                }
+                SetSubscription(std::move(subscription));
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    _incomingBuffer.erase(0, consumed);
+    return true;
+}
+
+void AIClientSession::HandleLine(std::string const& line)
+{
+    AICommand cmd;
+    if (!ParseTextCommand(line, cmd))
+        return;
+
+    QueueCommand(std::move(cmd));
+}
+
+void AIClientSession::QueueCommand(AICommand&& cmd)
+{
+    // Auch ohne Step: Reset- und Makro-Events gehen an die sendende Verbindung
+    cmd.sessionId = _id;
+    if (sAIMetrics->IsEnabled())
+        cmd.receivedAt = std::chrono::steady_clock::now();
+    if (!_stepOpen)
+    {
+        g_CommandQueue.Push(std::move(cmd));
+        return;
+    }
+
+    // Ein Step wird ganz oder gar nicht angewendet: zu viele Kommandos verwerfen den ganzen Step
+    if (_stepOverflow)
+        return;
+    if (_stepCommands.size() >= AI_MAX_STEP_COMMANDS)
+    {
+        LOG_ERROR("module", "AI-SOCKET: Step {} hat mehr als {} Kommandos, Step verworfen.", _stepId, AI_MAX_STEP_COMMANDS);
+        _stepOverflow = true;
+        _stepCommands.clear();
+        return;
+    }
+
+    cmd.stepId = _stepId;
+    _stepCommands.push_back(std::move(cmd));
+}
+
+void AIClientSession::BeginStep(uint64 stepId)
+{
+    // Ein nicht abgeschlossener Step wird beim nächsten Beginn abgeschickt
+    if (_stepOpen)
+        EndStep();
+
+    _stepOpen = true;
+    _stepOverflow = false;
+    _stepId = stepId;
+    _stepCommands.clear();
+}
+
+void AIClientSession::EndStep()
+{
+    if (!_stepOpen)
+        return;
+
+    _stepOpen = false;
+    if (_stepOverflow)
+    {
+        _stepOverflow = false;
+        SendFrame(MakeStepAck(_stepId, 0, AI_STEP_DROPPED));
+        return;
+    }
+
+    // Marker am Ende: der World-Thread bestätigt den Step erst, wenn alles angewendet ist
+    AICommand marker;
+    marker.sessionId = _id;
+    marker.stepId = _stepId;
+    _stepCommands.push_back(std::move(marker));
+
+    if (!g_CommandQueue.PushBatch(std::move(_stepCommands)))
+        SendFrame(MakeStepAck(_stepId, 0, AI_STEP_DROPPED));
+    _stepCommands.clear();
+}
+
+AIClientSession::FramePtr AIClientSession::MakeStepAck(uint64 stepId, uint64 version, AIStepStatus status) const
+{
+    if (_mode == AI_STREAM_BINARY)
+        return std::make_shared<std::string const>(EncodeBinaryStepAck(stepId, version, status));
+    return std::make_shared<std::string const>(BuildStepAck(stepId, version, status == AI_STEP_APPLIED));
+}
+
+AIClientSession::FramePtr AIClientSession::MakeEpisodeEvent(AIEpisodeEvent const& episode, uint64 version) const
+{
+    if (_mode == AI_STREAM_BINARY)
+        return std::make_shared<std::string const>(EncodeBinaryEpisode(episode.episode, version, episode.bots, episode.teleported));
+    return std::make_shared<std::string const>(BuildEpisodeEvent(episode, version));
+}
+
+AIClientSession::FramePtr AIClientSession::MakeMacroEvent(AIMacroEvent const& macro, uint64 version) const
+{
+    if (_mode == AI_STREAM_BINARY)
+        return std::make_shared<std::string const>(EncodeBinaryMacro(macro, version));
+    return std::make_shared<std::string const>(BuildMacroEvent(macro, version));
+}
+
+// Steuer-Kommandos der Verbindung selbst (nicht für einen Player):
+//   @delta     -> Delta-Stream, beginnt mit einem Keyframe
+//   @full      -> komplettes Dokument bei jedem Tick (Default)
+//   @keyframe  -> Resync, nächster Frame ist ein Keyframe
+//   @binary    -> ab sofort Binär-Frames in beide Richtungen (nicht umkehrbar).
+//                 Der Server bestätigt mit der Zeile "@binary", danach kommt nur noch Binär.
+//   @step <id> -> folgende Kommandos bis "@end" bilden einen Step (id > 0)
+//   @end       -> Step abschicken, Bestätigung kommt vor dem passenden State
+//   @roster    -> Roster jetzt und bei jeder Änderung (im Delta-/Binärmodus automatisch)
+//   @subscribe <bots> [<fields>] -> nur diese Player/Felder (AISubscription::Parse)
+//   @unsubscribe -> wieder alle Player mit allen Feldern
+//   @metrics   -> {"type": "metrics", "text": "..."} (AIController.Metrics.Enable)
+void AIClientSession::HandleControl(std::string const& line)
+{
+    if (_mode == AI_STREAM_BINARY)
+        return;
+
+    if (line.compare(0, 6, "@step ") == 0)
+    {
+        uint64 stepId = 0;
+        char const* begin = line.data() + 6;
+        std::from_chars_result result = std::from_chars(begin, line.data() + line.size(), stepId);
+        if (result.ec != std::errc() || result.ptr != line.data() + line.size() || !stepId)
+        {
+            LOG_ERROR("module", "AI-SOCKET: Ungültige Step-ID in '{}'", line);
+            return;
+        }
+        BeginStep(stepId);
+        return;
+    }
+
+    if (line == "@end")
+    {
+        EndStep();
+        return;
+    }
+
+    if (line.compare(0, 11, "@subscribe ") == 0)
+    {
+        auto subscription = std::make_shared<AISubscription>();
+        if (!subscription->Parse(std::string_view(line).substr(11)))
+        {
+            LOG_ERROR("module", "AI-SOCKET: Ungültige Subscription '{}'", line);
+            return;
+        }
+        SetSubscription(std::move(subscription));
+        return;
+    }
+
+    if (line == "@unsubscribe")
+    {
+        SetSubscription(nullptr);
+        return;
+    }
+
+    if (line == "@metrics")
+    {
+        SendMetrics();
+        return;
+    }
+
+    if (line == "@roster")
+    {
+        _rosterSubscribed = true;
+        SendRoster();
+        return;
+    }
+
+    if (line == "@binary")
+    {
+        _mode = AI_STREAM_BINARY;
+        _rosterSubscribed = true;
+        SendFrame(std::make_shared<std::string const>("@binary\n"));
+        SendRoster();
+    }
+    else if (line == "@delta")
+    {
+        _mode = AI_STREAM_DELTA;
+        _rosterSubscribed = true;
+        SendRoster();
+    }
+    else if (line == "@full")
+        _mode = AI_STREAM_FULL;
+    else if (line != "@keyframe")
+    {
+        LOG_ERROR("module", "AI-SOCKET: Unbekanntes Steuer-Kommando '{}'", line);
+        return;
+    }
+
+    _sent.reset();
+    SendState(_delivered);
+}
+
+// --- SERVER ---
+
+AIControllerServer::AIControllerServer() : _broadcastStrand(boost::asio::make_strand(_ioContext)), _frameCacheVersion(0), _keyframeInterval(25), _keepAliveInterval(500), _nextSessionId(0)
+{
+    for (std::atomic<uint32>& subscribers : _fieldSubscribers)
+        subscribers.store(0, std::memory_order_relaxed);
+}
+
+uint32 AIControllerServer::GetObservationFields() const
+{
+    uint32 fields = 0;
+    for (uint8 f = AI_FIRST_OBSERVATION_FIELD; f < MAX_AI_STATE_FIELDS; ++f)
+        if (_fieldSubscribers[f].load(std::memory_order_relaxed))
+            fields |= 1u << f;
+    return fields;
+}
+
+void AIControllerServer::RetainObservationFields(uint32 fields)
+{
+    for (uint8 f = AI_FIRST_OBSERVATION_FIELD; f < MAX_AI_STATE_FIELDS; ++f)
+        if (fields & (1u << f))
+            _fieldSubscribers[f].fetch_add(1, std::memory_order_relaxed);
+}
+
+void AIControllerServer::ReleaseObservationFields(uint32 fields)
+{
+    for (uint8 f = AI_FIRST_OBSERVATION_FIELD; f < MAX_AI_STATE_FIELDS; ++f)
+        if (fields & (1u << f))
+            _fieldSubscribers[f].fetch_sub(1, std::memory_order_relaxed);
+}
+
+AIControllerServer* AIControllerServer::instance()
+{
+    static AIControllerServer instance;
+    return &instance;
+}
+
+void AIControllerServer::Start(uint16 port, uint32 threadCount)
+{
+    if (_acceptor)
+        return;
+
+    try
+    {
+        _acceptor = std::make_unique<tcp::acceptor>(_ioContext, tcp::endpoint(tcp::v4(), port));
+    }
+    catch (std::exception const& e)
+    {
+        LOG_ERROR("module", "Server Crash: {}", e.what());
+        _acceptor.reset();
+        return;
+    }
+
+    LOG_INFO("module", ">>> AI-SOCKET: Lausche auf Port {} ({} Netzwerk-Threads)... <<<", port, threadCount);
+
+    _workGuard.emplace(_ioContext.get_executor());
+    DoAccept();
+
+    threadCount = std::max<uint32>(threadCount, 1);
+    for (uint32 i = 0; i < threadCount; ++i)
+    {
+        _threads.emplace_back([this]()
+        {
+            while (true)
+            {
+                try
+                {
+                    _ioContext.run();
+                    break;
+                }
+                catch (std::exception const& e)
+                {
+                    LOG_ERROR("module", "AI-SOCKET: Fehler im Netzwerk-Thread: {}", e.what());
+                }
+            }
+        });
+    }
+}
+
+void AIControllerServer::Stop()
+{
+    if (!_acceptor)
+        return;
+
+    _workGuard.reset();
+    _ioContext.stop();
+
+    for (std::thread& thread : _threads)
+        thread.join();
+    _threads.clear();
+
+    // Ab hier läuft kein Handler mehr, direkter Zugriff ist sicher
+    boost::system::error_code ec;
+    _acceptor->close(ec);
+
+    std::lock_guard<std::mutex> lock(_sessionsLock);
+    for (std::weak_ptr<AIClientSession> const& weak : _sessions)
+        if (std::shared_ptr<AIClientSession> session = weak.lock())
+            session->Close();
+    _sessions.clear();
+}
+
+void AIControllerServer::DoAccept()
+{
+    _acceptor->async_accept(boost::asio::make_strand(_ioContext),
+        [this](boost::system::error_code const& error, tcp::socket socket)
+        {
+            if (error == boost::asio::error::operation_aborted)
+                return;
+
+            if (!error)
+            {
+                auto session = std::make_shared<AIClientSession>(std::move(socket), *this);
+                {
+                    std::lock_guard<std::mutex> lock(_sessionsLock);
+                    _sessions.push_back(session);
+                }
+                session->Start();
+            }
+            else
+                LOG_ERROR("module", "AI-SOCKET: Accept fehlgeschlagen: {}", error.message());
+
+            DoAccept();
+        });
+}
+
+void AIControllerServer::NotifyStateChanged(AIStateSnapshotPtr state)
+{
+    if (!_acceptor)
+        return;
+
+    // Über einen Strand, damit die Posts an die Sessions in Versionsreihenfolge passieren
+    boost::asio::post(_broadcastStrand, [this, state = std::move(state)]() { Broadcast(state); });
+}
+
+AIStateSnapshotPtr AIControllerServer::GetLatestState()
+{
+    std::lock_guard<std::mutex> lock(g_StateMutex);
+    return g_CurrentState;
+}
+
+AIControllerServer::FrameCache* AIControllerServer::GetFrameCache(AIStateSnapshot const& current, AISubscription const* subscription)
+{
+    if (current.version != _frameCacheVersion)
+    {
+        // Veralteter Snapshot (langsamer Client): nicht cachen
+        if (current.version < _frameCacheVersion)
+            return nullptr;
+
+        _frameCacheVersion = current.version;
+        _frameCaches.clear();
+    }
+
+    static std::string const allKey;
+    return &_frameCaches[subscription ? subscription->GetKey() : allKey];
+}
+
+AIClientSession::FramePtr AIControllerServer::GetFullFrame(AIStateSnapshotPtr const& current, AISubscription const& subscription)
+{
+    std::lock_guard<std::mutex> lock(_frameCacheLock);
+    FrameCache* cache = GetFrameCache(*current, &subscription);
+    if (!cache)
+        return std::make_shared<std::string const>(BuildFullFrame(*current, subscription));
+
+    if (!cache->full)
+        cache->full = std::make_shared<std::string const>(BuildFullFrame(*current, subscription));
+    return cache->full;
+}
+
+AIClientSession::FramePtr AIControllerServer::GetKeyframe(AIStateSnapshotPtr const& current, AISubscription const* subscription)
+{
+    std::lock_guard<std::mutex> lock(_frameCacheLock);
+    FrameCache* cache = GetFrameCache(*current, subscription);
+    if (!cache)
+        return std::make_shared<std::string const>(BuildKeyframe(*current, subscription));
+
+    if (!cache->keyframe)
+        cache->keyframe = std::make_shared<std::string const>(BuildKeyframe(*current, subscription));
+    return cache->keyframe;
+}
+
+AIClientSession::FramePtr AIControllerServer::GetDeltaFrame(AIStateSnapshotPtr const& base, AIStateSnapshotPtr const& current, AISubscription const* subscription)
+{
+    std::lock_guard<std::mutex> lock(_frameCacheLock);
+    FrameCache* cache = GetFrameCache(*current, subscription);
+    if (!cache)
+        return std::make_shared<std::string const>(BuildDeltaFrame(*base, *current, subscription));
+
+    // Die meisten Clients stehen auf derselben Basis -> ein Delta für alle
+    AIClientSession::FramePtr& frame = cache->deltas[base->version];
+    if (!frame)
+        frame = std::make_shared<std::string const>(BuildDeltaFrame(*base, *current, subscription));
+    return frame;
+}
+
+AIClientSession::FramePtr AIControllerServer::GetBinaryFrame(AIStateSnapshotPtr const& current, AISubscription const* subscription)
+{
+    std::lock_guard<std::mutex> lock(_frameCacheLock);
+    FrameCache* cache = GetFrameCache(*current, subscription);
+    if (!cache)
+        return std::make_shared<std::string const>(EncodeBinaryState(*current, subscription));
+
+    if (!cache->binary)
+        cache->binary = std::make_shared<std::string const>(EncodeBinaryState(*current, subscription));
+    return cache->binary;
+}
+
+std::string AIControllerServer::BuildMetricsReport()
+{
+    std::string report;
+    sAIMetrics->AppendReport(report);
+    report += "queue_depth " + std::to_string(g_CommandQueue.GetSize()) + '\n';
+
+    std::lock_guard<std::mutex> lock(_sessionsLock);
+    for (std::weak_ptr<AIClientSession> const& weak : _sessions)
+    {
+        if (std::shared_ptr<AIClientSession> session = weak.lock())
+        {
+            report += "client " + std::to_string(session->GetId());
+            report += " bytes=" + std::to_string(session->GetBytesSent());
+            report += " frames=" + std::to_string(session->GetFramesSent());
+            report += '\n';
+        }
+    }
+    return report;
+}
+
+void AIControllerServer::PublishRoster(std::vector<AIRosterEntry> const& roster)
+{
+    auto json = std::make_shared<std::string const>(BuildRosterFrame(roster));
+    auto binary = std::make_shared<std::string const>(EncodeBinaryRoster(roster));
+    {
+        std::lock_guard<std::mutex> lock(_rosterLock);
+        _rosterJson = std::move(json);
+        _rosterBinary = std::move(binary);
+    }
+
+    if (_acceptor)
+        boost::asio::post(_ioContext, [this]() { BroadcastRoster(); });
+}
+
+AIClientSession::FramePtr AIControllerServer::GetRosterFrame(bool binary)
+{
+    std::lock_guard<std::mutex> lock(_rosterLock);
+    return binary ? _rosterBinary : _rosterJson;
+}
+
+void AIControllerServer::BroadcastRoster()
+{
+    std::lock_guard<std::mutex> lock(_sessionsLock);
+    for (std::weak_ptr<AIClientSession> const& weak : _sessions)
+        if (std::shared_ptr<AIClientSession> session = weak.lock())
+            session->QueueRoster();
+}
+
+void AIControllerServer::Broadcast(AIStateSnapshotPtr const& state)
+{
+    std::lock_guard<std::mutex> lock(_sessionsLock);
+    for (auto itr = _sessions.begin(); itr != _sessions.end();)
+    {
+        if (std::shared_ptr<AIClientSession> session = itr->lock())
+        {
+            session->QueueState(state);
+            ++itr;
+        }
+        else
+            itr = _sessions.erase(itr);
+    }
+}
@@ -0,0 +1,212 @@
+/*
+ * Asynchroner Socket-Server für externe AI-Clients.
+ *
+ * Ein einziger boost::asio::io_context, bedient von einem kleinen Thread-Pool
+ * (AIController.NetworkThreads). Jede Verbindung läuft auf ihrem eigenen Strand,
+ * es gibt also keinen Thread pro Client und kein Polling mehr.
+ */
+
+#ifndef MOD_AI_CONTROLLER_SERVER_H
+#define MOD_AI_CONTROLLER_SERVER_H
+
+#include "AIController.h"
+#include "AIState.h"
+#include "Define.h"
+#include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class AIControllerServer;
+
+enum AIStreamMode : uint8
+{
+    AI_STREAM_FULL,     // Jeder Tick das komplette Dokument (Default, Legacy)
+    AI_STREAM_DELTA,    // Nur Änderungen, periodisch ein Keyframe
+    AI_STREAM_BINARY    // Length-prefixed Binär-Frames in beide Richtungen (AIProtocol.h)
+};
+
+class AIClientSession : public std::enable_shared_from_this<AIClientSession>
+{
+public:
+    using FramePtr = std::shared_ptr<std::string const>;
+
+    AIClientSession(boost::asio::ip::tcp::socket&& socket, AIControllerServer& server);
+    ~AIClientSession();
+
+    void Start();
+    void Close();
+
+    // Beliebiger Thread (Metrics-Report)
+    uint32 GetId() const { return _id; }
+    uint64 GetBytesSent() const { return _bytesSent.load(std::memory_order_relaxed); }
+    uint64 GetFramesSent() const { return _framesSent.load(std::memory_order_relaxed); }
+
+    // Thread-safe: wird auf den Strand der Session gepostet. Nur für veröffentlichte
+    // Snapshots in Reihenfolge (Broadcast), sie bestätigen Steps, Resets und Makros.
+    void QueueState(AIStateSnapshotPtr state);
+    void QueueRoster();
+
+private:
+    void DoRead();
+    void DoWrite();
+    void WriteNext();
+    void ScheduleKeepAlive();
+    void ProcessIncoming();
+    bool ProcessBinaryFrames();
+    void HandleLine(std::string const& line);
+    void HandleControl(std::string const& line);
+    void QueueCommand(AICommand&& cmd);
+    void BeginStep(uint64 stepId);
+    void EndStep();
+    FramePtr MakeStepAck(uint64 stepId, uint64 version, AIStepStatus status) const;
+    FramePtr MakeEpisodeEvent(AIEpisodeEvent const& episode, uint64 version) const;
+    FramePtr MakeMacroEvent(AIMacroEvent const& macro, uint64 version) const;
+    void SendState(AIStateSnapshotPtr state);
+    void SendFrame(FramePtr frame);
+    void SendRoster();
+    void SendMetrics();
+    void SetSubscription(std::shared_ptr<AISubscription const> subscription);
+    FramePtr EncodeState(AIStateSnapshotPtr const& state);
+
+    boost::asio::ip::tcp::socket _socket;
+    AIControllerServer& _server;
+    uint32 _id;
+    boost::asio::steady_timer _keepAliveTimer;
+
+    std::array<char, 8192> _readBuffer;
+    std::string _incomingBuffer;
+
+    // Nur der jeweils neueste State wird gepuffert. Ein langsamer Client
+    // bekommt Zwischenstände nicht, statt dass sich eine Queue aufstaut.
+    FramePtr _writing;
+    AIStateSnapshotPtr _pending;
+
+    // Heartbeats/Antworten, werden vor dem nächsten State gesendet
+    std::deque<FramePtr> _controlFrames;
+
+    // Letzter gesendeter Snapshot = Basis für das nächste Delta
+    AIStateSnapshotPtr _sent;
+
+    // Letzter zugestellter Snapshot (Connect bzw. QueueState). Keepalive und neue Auswahl
+    // senden ihn statt des neuesten, damit kein Snapshot vor seinen Acks rausgeht.
+    AIStateSnapshotPtr _delivered;
+    AIStreamMode _mode;
+    uint32 _deltasSinceKeyframe;
+
+    // Roster (Bot-Handles) nur an Clients, die damit rechnen
+    bool _rosterSubscribed;
+
+    // nullptr = alle Player, Standardfelder
+    std::shared_ptr<AISubscription const> _subscription;
+
+    // Offener Step: Kommandos werden gesammelt und bei "Ende" als Ganzes eingereiht
+    bool _stepOpen;
+    bool _stepOverflow;             // mehr als AI_MAX_STEP_COMMANDS: der ganze Step wird verworfen
+    uint64 _stepId;
+    std::vector<AICommand> _stepCommands;
+    uint64 _lastAckVersion;
+
+    std::chrono::steady_clock::time_point _lastSend;
+    bool _closed;
+
+    // Nur mit AIController.Metrics.Enable gezählt
+    std::atomic<uint64> _bytesSent;
+    std::atomic<uint64> _framesSent;
+};
+
+class AIControllerServer
+{
+public:
+    static AIControllerServer* instance();
+
+    void Start(uint16 port, uint32 threadCount);
+    void Stop();
+
+    // Vom World-Thread nach jedem Snapshot aufgerufen. Kostet dort nur ein post();
+    // die Snapshots erreichen jede Session in der Reihenfolge der Aufrufe.
+    void NotifyStateChanged(AIStateSnapshotPtr state);
+
+    AIStateSnapshotPtr GetLatestState();
+
+    // Frames werden pro Version und Subscription einmal gebaut und von allen
+    // Clients mit derselben Auswahl geteilt; subscription nullptr = alles
+    AIClientSession::FramePtr GetFullFrame(AIStateSnapshotPtr const& current, AISubscription const& subscription);
+    AIClientSession::FramePtr GetKeyframe(AIStateSnapshotPtr const& current, AISubscription const* subscription);
+    AIClientSession::FramePtr GetDeltaFrame(AIStateSnapshotPtr const& base, AIStateSnapshotPtr const& current, AISubscription const* subscription);
+    AIClientSession::FramePtr GetBinaryFrame(AIStateSnapshotPtr const& current, AISubscription const* subscription);
+
+    // Vom World-Thread, wenn Bots ein- oder ausloggen
+    void PublishRoster(std::vector<AIRosterEntry> const& roster);
+    AIClientSession::FramePtr GetRosterFrame(bool binary);
+
+    uint32 NextSessionId() { return ++_nextSessionId; }
+
+    // Metriken (AIMetrics) plus Queue-Tiefe und eine Zeile pro verbundenem Client
+    std::string BuildMetricsReport();
+
+    uint32 GetKeyframeInterval() const { return _keyframeInterval; }
+    void SetKeyframeInterval(uint32 interval) { _keyframeInterval = interval; }
+
+    // Millisekunden, 0 = kein Keepalive
+    uint32 GetKeepAliveInterval() const { return _keepAliveInterval; }
+    void SetKeepAliveInterval(uint32 interval) { _keepAliveInterval = interval; }
+
+    // Beobachtungsfelder, die mindestens eine Session abonniert hat; nur diese
+    // sammelt der World-Thread. Retain/Release aus den Sessions, pro gesetztem Bit.
+    uint32 GetObservationFields() const;
+    void RetainObservationFields(uint32 fields);
+    void ReleaseObservationFields(uint32 fields);
+
+private:
+    AIControllerServer();
+
+    struct FrameCache
+    {
+        AIClientSession::FramePtr full;
+        AIClientSession::FramePtr keyframe;
+        AIClientSession::FramePtr binary;
+        std::unordered_map<uint64, AIClientSession::FramePtr> deltas;   // Key = Basis-Version
+    };
+
+    void DoAccept();
+    void Broadcast(AIStateSnapshotPtr const& state);
+    void BroadcastRoster();
+
+    // Nur unter _frameCacheLock; nullptr für einen veralteten Snapshot (nicht cachen)
+    FrameCache* GetFrameCache(AIStateSnapshot const& current, AISubscription const* subscription);
+
+    boost::asio::io_context _ioContext;
+    boost::asio::strand<boost::asio::io_context::executor_type> _broadcastStrand;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> _workGuard;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> _acceptor;
+    std::vector<std::thread> _threads;
+
+    std::mutex _sessionsLock;
+    std::vector<std::weak_ptr<AIClientSession>> _sessions;
+
+    std::mutex _frameCacheLock;
+    uint64 _frameCacheVersion;
+    std::unordered_map<std::string, FrameCache> _frameCaches;     // Key = AISubscription::GetKey(), "" = alles
+
+    std::atomic<uint32> _keyframeInterval;
+    std::atomic<uint32> _keepAliveInterval;
+    std::atomic<uint32> _nextSessionId;
+    std::array<std::atomic<uint32>, MAX_AI_STATE_FIELDS> _fieldSubscribers;
+
+    std::mutex _rosterLock;
+    AIClientSession::FramePtr _rosterJson;
+    AIClientSession::FramePtr _rosterBinary;
+};
+
+#define sAIServer AIControllerServer::instance()
+
+#endif
@@ -0,0 +1,164 @@
+#include "AIEpisode.h"
+#include "Bag.h"
+#include "Item.h"
+#include "Map.h"
+#include "MotionMaster.h"
+#include "Player.h"
+#include "SpellAuras.h"
+#include <algorithm>
+
+namespace
+{
+    // Taschen-Inhalt vor der Tasche selbst, damit beim Zerstören nichts doppelt wegfällt
+    template<class Visitor>
+    void VisitItems(Player* player, Visitor&& visitor)
+    {
+        for (uint8 bagSlot = INVENTORY_SLOT_BAG_START; bagSlot < INVENTORY_SLOT_BAG_END; ++bagSlot)
+            if (Bag* bag = player->GetBagByPos(bagSlot))
+                for (uint32 slot = 0; slot < bag->GetBagSize(); ++slot)
+                    if (Item* item = bag->GetItemByPos(uint8(slot)))
+                        visitor(item, bagSlot, uint8(slot));
+
+        for (uint8 slot = EQUIPMENT_SLOT_START; slot < INVENTORY_SLOT_ITEM_END; ++slot)
+            if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot))
+                visitor(item, uint8(INVENTORY_SLOT_BAG_0), slot);
+    }
+
+    void RestoreInventory(Player* player, AIEpisodeCheckpoint const& checkpoint)
+    {
+        // Angelegte Upgrades zurücktauschen, solange das alte Item noch da ist
+        for (uint8 slot = EQUIPMENT_SLOT_START; slot < EQUIPMENT_SLOT_END; ++slot)
+        {
+            ObjectGuid wanted = checkpoint.equipment[slot];
+            Item* current = player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot);
+            if (!wanted || (current && current->GetGUID() == wanted))
+                continue;
+
+            if (Item* item = player->GetItemByGuid(wanted))
+                player->SwapItem(item->GetPos(), (INVENTORY_SLOT_BAG_0 << 8) | slot);
+        }
+
+        // Alles, was in der Episode dazukam, wieder entfernen; Stapel auf die alte Größe
+        // (Beute, die auf einen vorhandenen Stapel kam, oder teilweise Verbrauchtes)
+        std::vector<std::pair<uint8, uint8>> gained;
+        VisitItems(player, [&](Item* item, uint8 bag, uint8 slot)
+        {
+            auto itr = checkpoint.items.find(item->GetGUID());
+            if (itr == checkpoint.items.end())
+            {
+                gained.emplace_back(bag, slot);
+                return;
+            }
+
+            if (item->GetCount() != itr->second)
+            {
+                item->SetCount(itr->second);
+                item->SetState(ITEM_CHANGED, player);
+                item->SendUpdateToPlayer(player);
+            }
+        });
+
+        for (auto const& [bag, slot] : gained)
+            player->DestroyItem(bag, slot, true);
+    }
+}
+
+void CaptureEpisodeCheckpoint(Player* player, AIEpisodeCheckpoint& checkpoint)
+{
+    checkpoint.mapId = player->GetMapId();
+    player->GetPosition(checkpoint.x, checkpoint.y, checkpoint.z, checkpoint.o);
+
+    checkpoint.health = std::max<uint32>(player->GetHealth(), 1);
+    checkpoint.power.assign(MAX_POWERS, 0);
+    for (uint8 power = 0; power < MAX_POWERS; ++power)
+        checkpoint.power[power] = player->GetPower(Powers(power));
+    checkpoint.money = player->GetMoney();
+    checkpoint.xp = player->GetUInt32Value(PLAYER_XP);
+
+    checkpoint.equipment.assign(EQUIPMENT_SLOT_END, ObjectGuid::Empty);
+    for (uint8 slot = EQUIPMENT_SLOT_START; slot < EQUIPMENT_SLOT_END; ++slot)
+        if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot))
+            checkpoint.equipment[slot] = item->GetGUID();
+
+    checkpoint.items.clear();
+    VisitItems(player, [&](Item* item, uint8 /*bag*/, uint8 /*slot*/)
+    {
+        checkpoint.items[item->GetGUID()] = item->GetCount();
+    });
+
+    checkpoint.auras.clear();
+    for (auto const& [spellId, aurApp] : player->GetAppliedAuras())
+        if (!aurApp->GetBase()->IsPassive())
+            checkpoint.auras.insert(spellId);
+}
+
+AIEpisodeResetResult ResetEpisode(Player* player, AIEpisodeCheckpoint const* checkpoint)
+{
+    player->CombatStop(true);
+    player->AttackStop();
+    player->GetMotionMaster()->Clear();
+    player->StopMoving();
+    player->SetSelection(ObjectGuid::Empty);
+    player->SetTarget(ObjectGuid::Empty);
+
+    if (!player->IsAlive())
+    {
+        player->ResurrectPlayer(1.0f, false);
+        player->SpawnCorpseBones();
+    }
+
+    // Passive Auren (Talente, Rasse, Haltungen) bleiben, sonst werden sie bei jedem Reset neu aufgebaut
+    if (!player->GetAppliedAuras().empty())
+    {
+        player->RemoveAppliedAuras([checkpoint](AuraApplication const* aurApp)
+        {
+            Aura const* aura = aurApp->GetBase();
+            if (aura->IsPassive())
+                return false;
+            return !checkpoint || !checkpoint->auras.count(aura->GetId());
+        });
+    }
+
+    if (!player->GetSpellCooldownMap().empty())
+        player->RemoveAllSpellCooldown();
+
+    uint32 mapId;
+    float x, y, z, o;
+    if (checkpoint)
+    {
+        RestoreInventory(player, *checkpoint);
+        if (player->GetMoney() != checkpoint->money)
+            player->SetMoney(checkpoint->money);
+        player->SetUInt32Value(PLAYER_XP, checkpoint->xp);
+
+        player->SetHealth(std::min(checkpoint->health, player->GetMaxHealth()));
+        for (uint8 power = 0; power < MAX_POWERS; ++power)
+            if (uint32 maxPower = player->GetMaxPower(Powers(power)))
+                player->SetPower(Powers(power), std::min(checkpoint->power[power], maxPower));
+
+        mapId = checkpoint->mapId;
+        x = checkpoint->x; y = checkpoint->y; z = checkpoint->z; o = checkpoint->o;
+    }
+    else
+    {
+        player->SetHealth(player->GetMaxHealth());
+        player->SetPower(player->getPowerType(), player->GetMaxPower(player->getPowerType()));
+
+        mapId = player->m_homebindMapId;
+        x = player->m_homebindX; y = player->m_homebindY; z = player->m_homebindZ; o = player->GetOrientation();
+    }
+
+    // Bots haben keinen Client, der einen Near-Teleport bestätigt: direkt in der Map umsetzen
+    if (mapId == player->GetMapId() && !player->IsBeingTeleported())
+    {
+        Map* map = player->GetMap();
+        if (!map->IsGridLoaded(x, y))
+            map->LoadGrid(x, y);
+        map->PlayerRelocation(player, x, y, z, o);
+        player->SendMovementFlagUpdate();
+        return AI_RESET_RELOCATED;
+    }
+
+    player->TeleportTo(mapId, x, y, z, o);
+    return AI_RESET_TELEPORTED;
+}
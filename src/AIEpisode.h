@@ -0,0 +1,51 @@
+/*
+ * Schneller Episoden-Reset für RL-Training.
+ *
+ * Ein Checkpoint hält fest, wo ein Bot steht und was er hat (HP, Power, Geld,
+ * XP, Items mit Stapelgröße, aktive Auren). Der Reset stellt das wieder her:
+ * neue Items werden zerstört, Stapel auf die alte Größe gesetzt. Items, die es
+ * nicht mehr gibt (verkauft, zerstört, ganz verbraucht), kommen nicht zurück,
+ * dafür reicht die GUID im Checkpoint nicht. Der Reset setzt
+ * den Bot auf derselben Map per Map::PlayerRelocation um, statt TeleportTo
+ * mit Grid-Laden und Teleport-Ack. Nur ein Ziel auf einer anderen Map geht
+ * noch über TeleportTo.
+ */
+
+#ifndef MOD_AI_CONTROLLER_EPISODE_H
+#define MOD_AI_CONTROLLER_EPISODE_H
+
+#include "Define.h"
+#include "ObjectGuid.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Player;
+
+struct AIEpisodeCheckpoint
+{
+    uint32 mapId = 0;
+    float x = 0.0f, y = 0.0f, z = 0.0f, o = 0.0f;
+
+    uint32 health = 0;
+    std::vector<uint32> power;              // Index = Powers
+    uint32 money = 0;
+    uint32 xp = 0;
+
+    std::vector<ObjectGuid> equipment;      // Index = EquipmentSlots
+    std::unordered_map<ObjectGuid, uint32> items;   // Ausrüstung, Taschen und Inhalt -> Stapelgröße
+    std::unordered_set<uint32> auras;       // Nicht-passive Auren beim Checkpoint
+};
+
+enum AIEpisodeResetResult : uint8
+{
+    AI_RESET_RELOCATED,     // Auf derselben Map umgesetzt
+    AI_RESET_TELEPORTED     // Andere Map, TeleportTo
+};
+
+void CaptureEpisodeCheckpoint(Player* player, AIEpisodeCheckpoint& checkpoint);
+
+// Ohne Checkpoint: Homebind, volle HP/Power, Inventar bleibt
+AIEpisodeResetResult ResetEpisode(Player* player, AIEpisodeCheckpoint const* checkpoint);
+
+#endif
@@ -0,0 +1,133 @@
+#include "AIInventory.h"
+#include "AIItemScore.h"
+#include "Bag.h"
+#include "Item.h"
+#include "ItemTemplate.h"
+#include "Player.h"
+#include "Timer.h"
+#include <algorithm>
+
+static_assert(EQUIPMENT_SLOT_END == 19, "AIInventorySummary::_equippedScore an EQUIPMENT_SLOT_END anpassen");
+
+namespace
+{
+    constexpr uint32 HearthstoneId = 6948;
+
+    // Zählt für freie Plätze: Rucksack und Inhalt der Taschen
+    bool IsStorageSlot(uint8 bag, uint8 slot)
+    {
+        if (bag == INVENTORY_SLOT_BAG_0)
+            return slot >= INVENTORY_SLOT_ITEM_START && slot < INVENTORY_SLOT_ITEM_END;
+        return bag >= INVENTORY_SLOT_BAG_START && bag < INVENTORY_SLOT_BAG_END;
+    }
+}
+
+uint32 CountFreeBagSlots(Player* player) {
+    uint32 freeSlots = 0;
+    for (uint8 slot = INVENTORY_SLOT_ITEM_START; slot < INVENTORY_SLOT_ITEM_END; ++slot) {
+        if (!player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot)) freeSlots++;
+    }
+    for (uint8 bag = INVENTORY_SLOT_BAG_START; bag < INVENTORY_SLOT_BAG_END; ++bag) {
+        Bag* bagItem = (Bag*)player->GetItemByPos(INVENTORY_SLOT_BAG_0, bag);
+        if (bagItem) freeSlots += bagItem->GetFreeSlots();
+    }
+    return freeSlots;
+}
+
+bool IsSellableItem(ItemTemplate const* proto)
+{
+    return proto && proto->SellPrice > 0 && proto->ItemId != HearthstoneId;
+}
+
+AIInventorySummary::AIInventorySummary() : _dirty(true), _lastRebuild(0), _freeSlots(0)
+{
+    _equippedScore.fill(-1);
+}
+
+void AIInventorySummary::Refresh(Player* player)
+{
+    if (_dirty.exchange(false, std::memory_order_relaxed) || getMSTimeDiff(_lastRebuild, getMSTime()) >= ResyncInterval)
+        Rebuild(player);
+}
+
+void AIInventorySummary::Rebuild(Player* player)
+{
+    _lastRebuild = getMSTime();
+    _freeSlots = CountFreeBagSlots(player);
+
+    for (uint8 slot = EQUIPMENT_SLOT_START; slot < EQUIPMENT_SLOT_END; ++slot)
+    {
+        Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot);
+        _equippedScore[slot] = item ? GetItemScore(item->GetTemplate(), player->getClass()) : -1;
+    }
+
+    _sellable.clear();
+    for (uint8 slot = INVENTORY_SLOT_ITEM_START; slot < INVENTORY_SLOT_ITEM_END; ++slot)
+        if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot))
+            if (IsSellableItem(item->GetTemplate()))
+                _sellable.push_back(item->GetPos());
+
+    for (uint8 bagSlot = INVENTORY_SLOT_BAG_START; bagSlot < INVENTORY_SLOT_BAG_END; ++bagSlot)
+        if (Bag* bag = player->GetBagByPos(bagSlot))
+            for (uint32 slot = 0; slot < bag->GetBagSize(); ++slot)
+                if (Item* item = bag->GetItemByPos(uint8(slot)))
+                    if (IsSellableItem(item->GetTemplate()))
+                        _sellable.push_back(item->GetPos());
+}
+
+uint32 AIInventorySummary::GetFreeSlots(Player* player)
+{
+    Refresh(player);
+    return _freeSlots;
+}
+
+int32 AIInventorySummary::GetEquippedScore(Player* player, uint8 slot)
+{
+    Refresh(player);
+    return slot < EQUIPMENT_SLOT_END ? _equippedScore[slot] : -1;
+}
+
+std::vector<uint16> const& AIInventorySummary::GetSellable(Player* player)
+{
+    Refresh(player);
+    return _sellable;
+}
+
+void AIInventorySummary::OnSlotUpdated(Player* player, uint16 pos, bool wasEmpty)
+{
+    // Veraltet: wird beim nächsten Zugriff ohnehin komplett neu gebaut
+    if (_dirty.load(std::memory_order_relaxed))
+        return;
+
+    uint8 bag = pos >> 8;
+    uint8 slot = pos & 255;
+    Item* item = player->GetItemByPos(bag, slot);
+
+    // Eine Tasche selbst ändert die Kapazität, das lohnt keine Sonderbehandlung
+    if (bag == INVENTORY_SLOT_BAG_0 && slot >= INVENTORY_SLOT_BAG_START && slot < INVENTORY_SLOT_BAG_END)
+    {
+        MarkDirty();
+        return;
+    }
+
+    if (bag == INVENTORY_SLOT_BAG_0 && slot < EQUIPMENT_SLOT_END)
+    {
+        _equippedScore[slot] = item ? GetItemScore(item->GetTemplate(), player->getClass()) : -1;
+        return;
+    }
+
+    if (!IsStorageSlot(bag, slot))
+        return;
+
+    if (wasEmpty && item && _freeSlots)
+        --_freeSlots;
+    else if (!wasEmpty && !item)
+        ++_freeSlots;
+
+    auto itr = std::find(_sellable.begin(), _sellable.end(), pos);
+    bool sellable = item && IsSellableItem(item->GetTemplate());
+    if (sellable && itr == _sellable.end())
+        _sellable.push_back(pos);
+    else if (!sellable && itr != _sellable.end())
+        _sellable.erase(itr);
+}
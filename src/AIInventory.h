@@ -0,0 +1,60 @@
+/*
+ * Inventar-Zusammenfassung pro Bot.
+ *
+ * Freie Taschenplätze, Score der angelegten Items und die verkaufbaren Items
+ * werden nicht bei jedem Snapshot neu gezählt. Das Modul meldet seine eigenen
+ * Änderungen (Loot, Anlegen, Verkaufen) per OnSlotUpdated, alle anderen
+ * Inventar-Änderungen markieren die Zusammenfassung über die Item-Hooks als
+ * veraltet; sie wird dann beim nächsten Zugriff einmal komplett neu gebaut.
+ */
+
+#ifndef MOD_AI_CONTROLLER_INVENTORY_H
+#define MOD_AI_CONTROLLER_INVENTORY_H
+
+#include "Define.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+class Player;
+struct ItemTemplate;
+
+// Vollständiger Scan über Rucksack und Taschen
+uint32 CountFreeBagSlots(Player* player);
+
+// Wird beim Händler verkauft (alles mit Verkaufspreis außer dem Ruhestein)
+bool IsSellableItem(ItemTemplate const* proto);
+
+class AIInventorySummary
+{
+public:
+    AIInventorySummary();
+
+    // Beliebiger Thread (Item-Hooks aus Map-Threads)
+    void MarkDirty() { _dirty.store(true, std::memory_order_relaxed); }
+
+    // Nur World-Thread, bauen bei Bedarf neu auf
+    uint32 GetFreeSlots(Player* player);
+    int32 GetEquippedScore(Player* player, uint8 slot);
+
+    // Positionen (bag << 8 | slot) aller verkaufbaren Items in Rucksack und Taschen
+    std::vector<uint16> const& GetSellable(Player* player);
+
+    // Nur World-Thread: Item an pos hat sich durch das Modul selbst geändert
+    void OnSlotUpdated(Player* player, uint16 pos, bool wasEmpty);
+
+    // Auch ohne Hook-Meldung regelmäßig neu zählen (Quest-Items, Mails, ...)
+    static constexpr uint32 ResyncInterval = 10000;
+
+private:
+    void Refresh(Player* player);
+    void Rebuild(Player* player);
+
+    std::atomic<bool> _dirty;
+    uint32 _lastRebuild;
+    uint32 _freeSlots;
+    std::array<int32, 19> _equippedScore;   // EQUIPMENT_SLOT_END
+    std::vector<uint16> _sellable;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "AIItemScore.h"
+#include "AIState.h"
+#include "Config.h"
+#include "ItemTemplate.h"
+#include "Log.h"
+#include "ObjectMgr.h"
+#include "SharedDefines.h"
+#include "StringConvert.h"
+#include "StringFormat.h"
+#include "Tokenize.h"
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+static_assert(MAX_ITEM_MOD <= AIItemScoreWeights::MaxStats, "AIItemScoreWeights::MaxStats zu klein");
+
+namespace
+{
+    struct StatName
+    {
+        std::string_view name;
+        uint32 stat;
+    };
+
+    constexpr StatName StatNames[] =
+    {
+        { "mana",           ITEM_MOD_MANA },
+        { "health",         ITEM_MOD_HEALTH },
+        { "agility",        ITEM_MOD_AGILITY },
+        { "strength",       ITEM_MOD_STRENGTH },
+        { "intellect",      ITEM_MOD_INTELLECT },
+        { "spirit",         ITEM_MOD_SPIRIT },
+        { "stamina",        ITEM_MOD_STAMINA },
+        { "defense",        ITEM_MOD_DEFENSE_SKILL_RATING },
+        { "dodge",          ITEM_MOD_DODGE_RATING },
+        { "parry",          ITEM_MOD_PARRY_RATING },
+        { "block",          ITEM_MOD_BLOCK_RATING },
+        { "hit",            ITEM_MOD_HIT_RATING },
+        { "crit",           ITEM_MOD_CRIT_RATING },
+        { "haste",          ITEM_MOD_HASTE_RATING },
+        { "expertise",      ITEM_MOD_EXPERTISE_RATING },
+        { "attack_power",   ITEM_MOD_ATTACK_POWER },
+        { "ranged_ap",      ITEM_MOD_RANGED_ATTACK_POWER },
+        { "mp5",            ITEM_MOD_MANA_REGENERATION },
+        { "armor_pen",      ITEM_MOD_ARMOR_PENETRATION_RATING },
+        { "spell_power",    ITEM_MOD_SPELL_POWER },
+        { "hp5",            ITEM_MOD_HEALTH_REGEN },
+        { "spell_pen",      ITEM_MOD_SPELL_PENETRATION },
+        { "block_value",    ITEM_MOD_BLOCK_VALUE }
+    };
+}
+
+bool AIItemScoreWeights::Parse(std::string const& text)
+{
+    bool valid = true;
+    for (std::string_view entry : Acore::Tokenize(text, ',', false))
+    {
+        std::size_t colon = entry.find(':');
+        if (colon == std::string_view::npos)
+        {
+            valid = false;
+            continue;
+        }
+
+        std::string_view name = TrimSpaces(entry.substr(0, colon));
+        Optional<float> weight = Acore::StringTo<float>(TrimSpaces(entry.substr(colon + 1)));
+        if (!weight)
+        {
+            valid = false;
+            continue;
+        }
+
+        if (name == "armor") armor = *weight;
+        else if (name == "damage") damage = *weight;
+        else if (name == "quality") quality = *weight;
+        else if (name == "item_level") itemLevel = *weight;
+        else if (Optional<uint32> stat = Acore::StringTo<uint32>(name); stat && *stat < MaxStats) stats[*stat] = *weight;
+        else
+        {
+            auto itr = std::find_if(std::begin(StatNames), std::end(StatNames), [name](StatName const& s) { return s.name == name; });
+            if (itr != std::end(StatNames))
+                stats[itr->stat] = *weight;
+            else
+                valid = false;
+        }
+    }
+    return valid;
+}
+
+AIItemScoreTable* AIItemScoreTable::instance()
+{
+    static AIItemScoreTable instance;
+    return &instance;
+}
+
+void AIItemScoreTable::LoadWeights()
+{
+    // Ohne Konfiguration entsprechen die Defaults der alten Formel
+    AIItemScoreWeights base;
+    if (!base.Parse(sConfigMgr->GetOption<std::string>("AIController.ItemScore.Weights", "")))
+        LOG_ERROR("module", "AI-GEAR: AIController.ItemScore.Weights enthält ungültige Einträge.");
+
+    _weights.assign(MAX_CLASSES, base);
+    for (uint8 classId = 1; classId < MAX_CLASSES; ++classId)
+    {
+        std::string key = Acore::StringFormat("AIController.ItemScore.Weights.{}", classId);
+        if (!_weights[classId].Parse(sConfigMgr->GetOption<std::string>(key, "", false)))
+            LOG_ERROR("module", "AI-GEAR: {} enthält ungültige Einträge.", key);
+    }
+}
+
+void AIItemScoreTable::Build()
+{
+    if (_weights.empty())
+        LoadWeights();
+
+    ItemTemplateContainer const* store = sObjectMgr->GetItemTemplateStore();
+    _maxItemId = 0;
+    for (auto const& [itemId, proto] : *store)
+        _maxItemId = std::max(_maxItemId, itemId);
+
+    std::size_t classes = _weights.size();
+    _scores.assign((std::size_t(_maxItemId) + 1) * classes, 0);
+    for (auto const& [itemId, proto] : *store)
+        for (std::size_t classId = 1; classId < classes; ++classId)
+            _scores[itemId * classes + classId] = Compute(&proto, _weights[classId]);
+
+    LOG_INFO("module", "AI-GEAR: Item-Scores für {} Items und {} Klassen berechnet.", store->size(), classes - 1);
+}
+
+int32 AIItemScoreTable::Compute(ItemTemplate const* proto, AIItemScoreWeights const& weights)
+{
+    float score = proto->Quality * weights.quality + proto->ItemLevel * weights.itemLevel + proto->Armor * weights.armor;
+    if (proto->Class == ITEM_CLASS_WEAPON)
+        score += (proto->Damage[0].DamageMax + proto->Damage[0].DamageMin) * weights.damage;
+    for (uint32 i = 0; i < proto->StatsCount && i < MAX_ITEM_PROTO_STATS; ++i)
+        if (proto->ItemStat[i].ItemStatType < AIItemScoreWeights::MaxStats)
+            score += proto->ItemStat[i].ItemStatValue * weights.stats[proto->ItemStat[i].ItemStatType];
+    return int32(std::lround(score));
+}
+
+int32 AIItemScoreTable::GetScore(uint32 itemId, uint8 classId) const
+{
+    std::size_t classes = _weights.size();
+    if (itemId <= _maxItemId && classId < classes && !_scores.empty())
+        return _scores[itemId * classes + classId];
+    return GetScore(sObjectMgr->GetItemTemplate(itemId), classId);
+}
+
+int32 AIItemScoreTable::GetScore(ItemTemplate const* proto, uint8 classId) const
+{
+    if (!proto)
+        return 0;
+
+    std::size_t classes = _weights.size();
+    if (proto->ItemId <= _maxItemId && classId < classes && !_scores.empty())
+        return _scores[proto->ItemId * classes + classId];
+
+    // Vor dem ersten Build oder Item außerhalb der Tabelle
+    static AIItemScoreWeights const defaults;
+    return Compute(proto, classId < classes ? _weights[classId] : defaults);
+}
@@ -0,0 +1,76 @@
+/*
+ * Item-Scores für Auto-Equip und Loot-Reward.
+ *
+ * Statt den Score bei jedem Loot aus dem ItemTemplate zu berechnen, wird einmal
+ * nach dem Laden der Items eine flache Tabelle [ItemId][Klasse] aufgebaut.
+ * Die Gewichte pro Stat kommen aus AIController.ItemScore.Weights (für alle
+ * Klassen) und AIController.ItemScore.Weights.<Klasse>; ".reload config" baut
+ * die Tabelle mit den neuen Gewichten neu auf.
+ */
+
+#ifndef MOD_AI_CONTROLLER_ITEM_SCORE_H
+#define MOD_AI_CONTROLLER_ITEM_SCORE_H
+
+#include "Define.h"
+#include <array>
+#include <string>
+#include <vector>
+
+struct ItemTemplate;
+
+// Gewichte einer Klasse; Stats über ItemModType indiziert
+struct AIItemScoreWeights
+{
+    static constexpr std::size_t MaxStats = 64;
+
+    std::array<float, MaxStats> stats;
+    float armor = 1.0f;
+    float damage = 1.0f;        // Min + Max des ersten Schadensbereichs
+    float quality = 10.0f;
+    float itemLevel = 1.0f;
+
+    AIItemScoreWeights() { stats.fill(2.0f); }
+
+    // "name:gewicht,name:gewicht", name = Stat-Name oder ItemModType-Nummer.
+    // Nicht genannte Werte bleiben; false, wenn ein Eintrag ungültig war.
+    bool Parse(std::string const& text);
+};
+
+class AIItemScoreTable
+{
+public:
+    static AIItemScoreTable* instance();
+
+    // OnAfterConfigLoad; die Tabelle wird beim nächsten Build neu berechnet
+    void LoadWeights();
+
+    // Nach dem Laden der ItemTemplates (OnStartup) und nach jedem LoadWeights
+    void Build();
+
+    int32 GetScore(uint32 itemId, uint8 classId) const;
+    int32 GetScore(ItemTemplate const* proto, uint8 classId) const;
+
+    std::size_t GetItemCount() const { return _maxItemId; }
+
+private:
+    AIItemScoreTable() : _maxItemId(0) { }
+
+    static int32 Compute(ItemTemplate const* proto, AIItemScoreWeights const& weights);
+
+    // Index = Klasse (CLASS_*), 0 ungenutzt
+    std::vector<AIItemScoreWeights> _weights;
+
+    // _scores[itemId * _weights.size() + klasse]
+    std::vector<int32> _scores;
+    uint32 _maxItemId;
+};
+
+#define sAIItemScore AIItemScoreTable::instance()
+
+// Kurzform für die Aufrufer
+inline int32 GetItemScore(ItemTemplate const* proto, uint8 classId)
+{
+    return sAIItemScore->GetScore(proto, classId);
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "AIMacro.h"
+#include "CellImpl.h"
+#include "Creature.h"
+#include "GridNotifiers.h"
+#include "GridNotifiersImpl.h"
+#include "MotionMaster.h"
+#include "Player.h"
+#include <algorithm>
+
+namespace
+{
+    // Wie der Collector der Perception, aber mit Filter statt SoA-Block
+    template<class Filter>
+    class CreatureVisitor {
+    public:
+        Filter& filter;
+        CreatureVisitor(Filter& f) : filter(f) {}
+
+        void Visit(CreatureMapType& m) {
+            for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr) {
+                Creature* creature = itr->GetSource();
+                if (creature && creature->IsInWorld()) filter(creature);
+            }
+        }
+        template<class SKIP> void Visit(GridRefMgr<SKIP>&) {}
+    };
+
+    template<class Filter>
+    void VisitCreatures(Player* player, float range, Filter&& filter)
+    {
+        CreatureVisitor<Filter> visitor(filter);
+        Cell::VisitObjects(player, visitor, range);
+    }
+}
+
+void FindLootableCorpses(Player* player, float range, std::vector<ObjectGuid>& corpses)
+{
+    std::vector<std::pair<float, ObjectGuid>> found;
+    VisitCreatures(player, range, [&](Creature* creature)
+    {
+        if (creature->IsAlive() || !creature->HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE))
+            return;
+        if (!player->IsWithinDistInMap(creature, range) || !player->isAllowedToLoot(creature))
+            return;
+        found.emplace_back(player->GetExactDistSq(creature), creature->GetGUID());
+    });
+
+    // Absteigend nach Distanz, das Makro arbeitet von hinten ab
+    std::sort(found.begin(), found.end(), [](auto const& a, auto const& b) { return a.first > b.first; });
+
+    corpses.clear();
+    corpses.reserve(found.size());
+    for (auto const& [distSq, guid] : found)
+        corpses.push_back(guid);
+}
+
+Creature* FindNearestVendor(Player* player, float range)
+{
+    Creature* nearest = nullptr;
+    float nearestDistSq = range * range;
+    VisitCreatures(player, range, [&](Creature* creature)
+    {
+        if (!creature->IsVendor() || !creature->IsAlive() || player->IsHostileTo(creature))
+            return;
+
+        float distSq = player->GetExactDistSq(creature);
+        if (distSq <= nearestDistSq)
+        {
+            nearest = creature;
+            nearestDistSq = distSq;
+        }
+    });
+    return nearest;
+}
+
+AIMacroMoveResult ApproachTarget(Player* player, AIMacroState& macro, WorldObject const* target, float distance)
+{
+    if (player->IsWithinDistInMap(target, distance))
+    {
+        if (macro.moving)
+        {
+            player->GetMotionMaster()->Clear();
+            player->StopMoving();
+        }
+        macro.ResetMove();
+        return AI_MACRO_ARRIVED;
+    }
+
+    // Der Weg läuft noch; hat er vor dem Ziel aufgehört, wird ein neuer berechnet
+    if (macro.moving && player->GetMotionMaster()->GetCurrentMovementGeneratorType() == POINT_MOTION_TYPE)
+        return AI_MACRO_MOVING;
+
+    if (macro.moveAttempts >= AI_MACRO_MAX_MOVE_ATTEMPTS)
+        return AI_MACRO_STUCK;
+
+    ++macro.moveAttempts;
+    macro.moving = true;
+    Position pos(target->GetPositionX(), target->GetPositionY(), target->GetPositionZ(), 0.0f);
+    player->GetMotionMaster()->MovePoint(1, pos, (ForcedMovement)0, 0.0f, true);
+    return AI_MACRO_MOVING;
+}
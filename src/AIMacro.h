@@ -0,0 +1,80 @@
+/*
+ * Makro-Aktionen: mehrstufige Abläufe, die der World-Thread selbst zu Ende führt.
+ *
+ * Statt für jede Leiche target_guid, move_to und loot_guid mit je einem
+ * State-Tick Wartezeit dazwischen zu schicken, startet der Client ein Makro
+ * und bekommt genau ein Event, wenn es fertig ist oder scheitert. Pro Bot
+ * läuft höchstens ein Makro; ein neues Makro, ein Reset oder ein Bewegungs-/
+ * Kampf-Kommando für denselben Bot bricht das laufende ab.
+ *
+ * Hier liegen nur Zustand, Zielsuche und Wegfindung; Loot und Verkauf selbst
+ * macht der Command-Dispatch (AIControllerHook.cpp), damit beide Wege
+ * dieselbe Inventar-Buchführung benutzen.
+ */
+
+#ifndef MOD_AI_CONTROLLER_MACRO_H
+#define MOD_AI_CONTROLLER_MACRO_H
+
+#include "AIProtocol.h"
+#include "Define.h"
+#include "ObjectGuid.h"
+#include <vector>
+
+class Creature;
+class Player;
+class WorldObject;
+
+struct AIMacroState
+{
+    AIAction action = AI_ACTION_NONE;   // AI_ACTION_NONE = kein Makro aktiv
+    uint32 session = 0;
+    uint32 startedAt = 0;               // getMSTime
+
+    ObjectGuid target;                  // attack, vendor_run
+    std::vector<ObjectGuid> corpses;    // loot_all: offene Leichen, nächste zuletzt
+    uint32 value = 0;                   // loot_all: geplünderte Leichen, vendor_run: Kupfer
+
+    bool moving = false;                // MovePoint zum aktuellen Ziel läuft
+    uint8 moveAttempts = 0;
+
+    bool IsActive() const { return action != AI_ACTION_NONE; }
+
+    // Vektor behält seine Kapazität für das nächste Makro
+    void Clear()
+    {
+        action = AI_ACTION_NONE;
+        session = 0;
+        target.Clear();
+        corpses.clear();
+        value = 0;
+        ResetMove();
+    }
+
+    void ResetMove()
+    {
+        moving = false;
+        moveAttempts = 0;
+    }
+};
+
+enum AIMacroMoveResult : uint8
+{
+    AI_MACRO_MOVING,
+    AI_MACRO_ARRIVED,
+    AI_MACRO_STUCK      // MaxMoveAttempts Wege ohne Ankunft
+};
+
+constexpr float AI_MACRO_LOOT_DISTANCE  = 5.0f;
+constexpr float AI_MACRO_VENDOR_DISTANCE = 5.0f;
+constexpr uint8 AI_MACRO_MAX_MOVE_ATTEMPTS = 3;
+
+// Tote, noch lootbare Kreaturen in range, die player looten darf; die nächste liegt hinten
+void FindLootableCorpses(Player* player, float range, std::vector<ObjectGuid>& corpses);
+
+// Nächster lebender Händler in range oder nullptr
+Creature* FindNearestVendor(Player* player, float range);
+
+// Läuft per Wegfindung zum Ziel, bis es näher als distance ist
+AIMacroMoveResult ApproachTarget(Player* player, AIMacroState& macro, WorldObject const* target, float distance);
+
+#endif
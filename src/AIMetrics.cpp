@@ -0,0 +1,142 @@
+#include "AIMetrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <string_view>
+
+namespace
+{
+    constexpr std::string_view HistogramNames[MAX_AI_HISTOGRAMS] =
+    {
+        "tick_us", "spawner_us", "perception_us", "commands_us", "macros_us", "snapshot_us", "observation_us",
+        "batch_size", "command_latency_us"
+    };
+
+    constexpr std::string_view CounterNames[MAX_AI_COUNTERS] =
+    {
+        "commands", "commands_dropped", "snapshots", "perception_scans", "bytes_sent", "frames_sent"
+    };
+
+    int64 Now()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+}
+
+// --- HISTOGRAM ---
+
+std::size_t AIHistogram::GetBucket(uint64 value)
+{
+    if (value < SubBuckets)
+        return std::size_t(value);
+
+    // Höchstes Bit wählt die Zweierpotenz, die zwei Bits darunter den Teil-Bucket
+    uint32 msb = uint32(std::bit_width(value)) - 1;
+    uint64 sub = (value >> (msb - 2)) & (SubBuckets - 1);
+    return (msb - 1) * SubBuckets + std::size_t(sub);
+}
+
+uint64 AIHistogram::GetBucketUpper(std::size_t bucket)
+{
+    if (bucket < SubBuckets)
+        return bucket;
+
+    uint32 msb = uint32(bucket / SubBuckets) + 1;
+    uint64 sub = bucket % SubBuckets;
+    uint64 lower = (SubBuckets + sub) << (msb - 2);
+    return lower + (uint64(1) << (msb - 2)) - 1;
+}
+
+void AIHistogram::Record(uint64 value)
+{
+    _buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64 max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+void AIHistogram::Reset()
+{
+    for (std::atomic<uint64>& bucket : _buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint64 AIHistogram::GetPercentile(double p) const
+{
+    // Während des Lesens kann weiter gezählt werden, daher gegen die Bucket-Summe rechnen
+    uint64 total = 0;
+    for (std::atomic<uint64> const& bucket : _buckets)
+        total += bucket.load(std::memory_order_relaxed);
+    if (!total)
+        return 0;
+
+    uint64 rank = std::max<uint64>(1, uint64(std::ceil(p * double(total))));
+    uint64 seen = 0;
+    for (std::size_t i = 0; i < BucketCount; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(GetBucketUpper(i), GetMax());
+    }
+    return GetMax();
+}
+
+// --- METRICS ---
+
+AIMetrics::AIMetrics() : _enabled(false), _since(Now())
+{
+    for (std::atomic<uint64>& counter : _counters)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+AIMetrics* AIMetrics::instance()
+{
+    static AIMetrics instance;
+    return &instance;
+}
+
+void AIMetrics::Reset()
+{
+    for (AIHistogram& histogram : _histograms)
+        histogram.Reset();
+    for (std::atomic<uint64>& counter : _counters)
+        counter.store(0, std::memory_order_relaxed);
+    _since.store(Now(), std::memory_order_relaxed);
+}
+
+void AIMetrics::AppendReport(std::string& out) const
+{
+    std::chrono::steady_clock::duration elapsed(Now() - _since.load(std::memory_order_relaxed));
+    out += "enabled ";
+    out += IsEnabled() ? "1" : "0";
+    out += "\nseconds ";
+    out += std::to_string(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count());
+    out += '\n';
+
+    for (std::size_t i = 0; i < MAX_AI_HISTOGRAMS; ++i)
+    {
+        AIHistogram const& histogram = _histograms[i];
+        uint64 count = histogram.GetCount();
+        out += HistogramNames[i];
+        out += " count=" + std::to_string(count);
+        out += " avg=" + std::to_string(count ? histogram.GetSum() / count : 0);
+        out += " p50=" + std::to_string(histogram.GetPercentile(0.50));
+        out += " p99=" + std::to_string(histogram.GetPercentile(0.99));
+        out += " max=" + std::to_string(histogram.GetMax());
+        out += '\n';
+    }
+
+    for (std::size_t i = 0; i < MAX_AI_COUNTERS; ++i)
+    {
+        out += CounterNames[i];
+        out += ' ';
+        out += std::to_string(_counters[i].load(std::memory_order_relaxed));
+        out += '\n';
+    }
+}
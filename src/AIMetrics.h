@@ -0,0 +1,135 @@
+/*
+ * Laufzeit-Metriken des Moduls: was kostet es im World-Tick, wie voll ist die
+ * Queue, wie lange warten Kommandos, wie viel geht an die Clients.
+ *
+ * Histogramme mit log-linearen Buckets (4 pro Zweierpotenz, ca. 20% Auflösung)
+ * und Zähler, alles atomar, damit World-Thread, Netzwerk-Threads und der
+ * GM-Befehl ohne Lock lesen und schreiben. Mit AIController.Metrics.Enable = 0
+ * kostet jede Messstelle nur einen relaxed Load, die Uhr wird nicht gelesen.
+ */
+
+#ifndef MOD_AI_CONTROLLER_METRICS_H
+#define MOD_AI_CONTROLLER_METRICS_H
+
+#include "Define.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+enum AIHistogramId : uint8
+{
+    AI_HIST_TICK,               // OnUpdate gesamt, µs
+    AI_HIST_SPAWNER,            // Bot-Logins inkl. ProcessReadyCallbacks, µs
+    AI_HIST_PERCEPTION,         // Grid-Scans (CreatureCollector), µs
+    AI_HIST_COMMANDS,           // Queue übernehmen und anwenden, µs
+    AI_HIST_MACROS,             // Makro-Schritte, µs
+    AI_HIST_SNAPSHOT,           // Snapshot bauen und veröffentlichen, µs
+    AI_HIST_OBSERVATION,        // Beobachtungsfelder sammeln (Teil von snapshot), µs
+    AI_HIST_BATCH_SIZE,         // Kommandos pro Tick
+    AI_HIST_COMMAND_LATENCY,    // Eingang im Netzwerk-Thread bis Anwendung, µs
+    MAX_AI_HISTOGRAMS
+};
+
+enum AICounterId : uint8
+{
+    AI_COUNTER_COMMANDS,        // Angewendete Kommandos
+    AI_COUNTER_DROPPED,         // Wegen voller Queue verworfen
+    AI_COUNTER_SNAPSHOTS,
+    AI_COUNTER_SCANS,           // Grid-Visits der Perception
+    AI_COUNTER_BYTES_SENT,      // Alle Clients zusammen
+    AI_COUNTER_FRAMES_SENT,
+    MAX_AI_COUNTERS
+};
+
+class AIHistogram
+{
+public:
+    static constexpr std::size_t SubBuckets = 4;
+    static constexpr std::size_t BucketCount = SubBuckets * 64;
+
+    AIHistogram() { Reset(); }
+
+    void Record(uint64 value);
+    void Reset();
+
+    uint64 GetCount() const { return _count.load(std::memory_order_relaxed); }
+    uint64 GetMax() const { return _max.load(std::memory_order_relaxed); }
+    uint64 GetSum() const { return _sum.load(std::memory_order_relaxed); }
+
+    // Obere Grenze des Buckets, in dem das Perzentil liegt (0 < p <= 1)
+    uint64 GetPercentile(double p) const;
+
+private:
+    static std::size_t GetBucket(uint64 value);
+    static uint64 GetBucketUpper(std::size_t bucket);
+
+    std::array<std::atomic<uint64>, BucketCount> _buckets;
+    std::atomic<uint64> _count;
+    std::atomic<uint64> _sum;
+    std::atomic<uint64> _max;
+};
+
+class AIMetrics
+{
+public:
+    static AIMetrics* instance();
+
+    bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+    // Beliebiger Thread; ohne Enable sofort zurück
+    void Record(AIHistogramId id, uint64 value)
+    {
+        if (IsEnabled())
+            _histograms[id].Record(value);
+    }
+
+    void Add(AICounterId id, uint64 value = 1)
+    {
+        if (IsEnabled())
+            _counters[id].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Reset();
+
+    // Eine Zeile pro Histogramm/Zähler, "name count=... p50=... p99=... max=..."
+    void AppendReport(std::string& out) const;
+
+private:
+    AIMetrics();
+
+    std::atomic<bool> _enabled;
+    std::array<AIHistogram, MAX_AI_HISTOGRAMS> _histograms;
+    std::array<std::atomic<uint64>, MAX_AI_COUNTERS> _counters;
+    std::atomic<int64> _since;          // steady_clock-Ticks des letzten Reset
+};
+
+#define sAIMetrics AIMetrics::instance()
+
+// Misst die Laufzeit des Scopes in µs
+class AIMetricTimer
+{
+public:
+    explicit AIMetricTimer(AIHistogramId id) : _id(id), _active(sAIMetrics->IsEnabled())
+    {
+        if (_active)
+            _start = std::chrono::steady_clock::now();
+    }
+
+    ~AIMetricTimer()
+    {
+        if (_active)
+            sAIMetrics->Record(_id, uint64(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count()));
+    }
+
+    AIMetricTimer(AIMetricTimer const&) = delete;
+    AIMetricTimer& operator=(AIMetricTimer const&) = delete;
+
+private:
+    AIHistogramId _id;
+    bool _active;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#endif
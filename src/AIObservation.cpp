@@ -0,0 +1,199 @@
+#include "AIObservation.h"
+#include "AIPerception.h"
+#include "Config.h"
+#include "Creature.h"
+#include "Log.h"
+#include "Player.h"
+#include "SharedDefines.h"
+#include "Spell.h"
+#include "SpellAuras.h"
+#include "SpellInfo.h"
+#include "StringConvert.h"
+#include "StringFormat.h"
+#include "ThreatMgr.h"
+#include "Timer.h"
+#include "Tokenize.h"
+#include <algorithm>
+
+bool AIObservationCollector::ParseSpells(std::string const& text, std::vector<uint32>& out)
+{
+    out.clear();
+    bool valid = true;
+    for (std::string_view entry : Acore::Tokenize(text, ',', false))
+    {
+        Optional<uint32> spellId = Acore::StringTo<uint32>(TrimSpaces(entry));
+        if (!spellId || out.size() >= AI_OBS_COOLDOWN_SLOTS)
+        {
+            valid = false;
+            continue;
+        }
+        out.push_back(*spellId);
+    }
+    return valid;
+}
+
+void AIObservationCollector::LoadSpells()
+{
+    std::vector<uint32> base;
+    if (!ParseSpells(sConfigMgr->GetOption<std::string>("AIController.Observation.Spells", ""), base))
+        LOG_ERROR("module", "AI-OBS: AIController.Observation.Spells enthält ungültige Einträge (höchstens {} Spells).", AI_OBS_COOLDOWN_SLOTS);
+
+    // Eine Klassen-Liste ersetzt die allgemeine komplett, damit die Positionen eindeutig bleiben
+    _spells.assign(MAX_CLASSES, base);
+    for (uint8 classId = 1; classId < MAX_CLASSES; ++classId)
+    {
+        std::string key = Acore::StringFormat("AIController.Observation.Spells.{}", classId);
+        std::string text = sConfigMgr->GetOption<std::string>(key, "", false);
+        if (!text.empty() && !ParseSpells(text, _spells[classId]))
+            LOG_ERROR("module", "AI-OBS: {} enthält ungültige Einträge (höchstens {} Spells).", key, AI_OBS_COOLDOWN_SLOTS);
+    }
+}
+
+std::vector<uint32> const& AIObservationCollector::GetSpells(uint8 classId) const
+{
+    static std::vector<uint32> const none;
+    return classId < _spells.size() ? _spells[classId] : none;
+}
+
+void AIObservationCollector::Collect(Player* player, uint32 fields, AIBotPerception const* perception, AIPlayerObservation& out)
+{
+    out = AIPlayerObservation();
+    if (fields & (1u << AI_FIELD_AURAS))
+        CollectAuras(player, out);
+    if (fields & (1u << AI_FIELD_COOLDOWNS))
+        CollectCooldowns(player, out);
+    if (fields & (1u << AI_FIELD_CAST))
+        CollectCast(player, out);
+    if (fields & (1u << AI_FIELD_TARGET_INFO))
+        CollectTarget(player, out);
+    if (fields & (1u << AI_FIELD_THREAT))
+        CollectThreat(player, perception, out);
+}
+
+void AIObservationCollector::Prune(uint32 fields)
+{
+    // Ein Bot, der ausgeloggt ist oder nicht mehr beobachtet wird, darf keinen Eintrag behalten:
+    // ein neuer Spell an derselben Adresse würde sonst als der alte Cast weiterlaufen
+    if (!(fields & (1u << AI_FIELD_CAST)))
+        _casts.clear();
+    else
+        std::erase_if(_casts, [this](auto const& entry) { return entry.second.generation != _generation; });
+    ++_generation;
+}
+
+void AIObservationCollector::CollectAuras(Player* player, AIPlayerObservation& out) const
+{
+    // Nur sichtbare Auren (Buff-Leiste); Debuffs zuerst, falls die Slots nicht reichen
+    std::size_t count = 0;
+    for (bool negative : { true, false })
+    {
+        for (auto const& [spellId, application] : player->GetAppliedAuras())
+        {
+            if (count >= out.auras.size())
+                return;
+            if (application->GetSlot() >= MAX_AURAS || application->IsPositive() == negative)
+                continue;
+
+            Aura const* aura = application->GetBase();
+            AIPlayerObservation::Aura& slot = out.auras[count++];
+            slot.spellId = spellId;
+            slot.remainingMs = aura->GetDuration();
+            slot.stacks = std::max<uint8>(aura->GetStackAmount(), aura->GetCharges());
+            slot.negative = negative;
+        }
+    }
+}
+
+void AIObservationCollector::CollectCooldowns(Player* player, AIPlayerObservation& out) const
+{
+    std::vector<uint32> const& spells = GetSpells(player->getClass());
+    out.cooldownCount = uint8(spells.size());
+    for (std::size_t i = 0; i < spells.size(); ++i)
+        out.cooldowns[i] = player->HasSpell(spells[i]) ? int32(player->GetSpellCooldownDelay(spells[i])) : -1;
+}
+
+void AIObservationCollector::CollectCast(Player* player, AIPlayerObservation& out)
+{
+    uint64 guid = player->GetGUID().GetRawValue();
+    Spell const* spell = player->GetCurrentSpell(CURRENT_CHANNELED_SPELL);
+    bool channeled = spell != nullptr;
+    if (!spell)
+        spell = player->GetCurrentSpell(CURRENT_GENERIC_SPELL);
+    if (!spell)
+    {
+        _casts.erase(guid);
+        return;
+    }
+
+    // Der Core gibt den Cast-Timer nicht heraus; der Start ist der erste Snapshot,
+    // in dem der Cast zu sehen ist (auf ein Snapshot-Intervall genau)
+    uint32 now = getMSTime();
+    CastTrack& track = _casts[guid];
+    if (track.spell != spell || track.spellId != spell->GetSpellInfo()->Id)
+    {
+        track.spell = spell;
+        track.spellId = spell->GetSpellInfo()->Id;
+        track.startedAt = now;
+    }
+    track.generation = _generation;
+
+    int32 total = channeled ? spell->GetSpellInfo()->GetDuration() : spell->GetCastTime();
+    uint32 elapsed = getMSTimeDiff(track.startedAt, now);
+    out.castSpell = track.spellId;
+    out.castChanneled = channeled;
+    if (total > 0)
+    {
+        out.castProgress = std::min(1.0f, float(elapsed) / float(total));
+        out.castRemainingMs = elapsed < uint32(total) ? uint32(total) - elapsed : 0;
+    }
+}
+
+void AIObservationCollector::CollectTarget(Player* player, AIPlayerObservation& out) const
+{
+    Unit* target = player->GetSelectedUnit();
+    if (!target)
+        return;
+
+    out.targetLevel = uint8(target->GetLevel());
+    out.targetHostile = player->IsHostileTo(target);
+    out.targetHp = target->GetHealth();
+    out.targetMaxHp = target->GetMaxHealth();
+    out.targetPower = target->GetPower(target->getPowerType());
+    out.targetMaxPower = target->GetMaxPower(target->getPowerType());
+    out.targetEntry = target->IsPlayer() ? 0 : target->GetEntry();
+    out.targetDistance = player->GetDistance(target);
+}
+
+void AIObservationCollector::CollectThreat(Player* player, AIBotPerception const* perception, AIPlayerObservation& out)
+{
+    // Jeder Eintrag im HostileRefMgr ist ein Gegner, auf dessen Threat-Liste der Bot steht
+    _threat.clear();
+    for (HostileReference* ref = player->getHostileRefMgr().getFirst(); ref; ref = ref->next())
+    {
+        Unit* enemy = ref->GetSource()->GetOwner();
+        if (!enemy || !enemy->IsAlive())
+            continue;
+
+        AIPlayerObservation::Threat& threat = _threat.emplace_back();
+        threat.entry = enemy->GetEntry();
+        threat.threat = ref->GetThreat();
+        threat.attackingMe = enemy->GetVictim() == player;
+        if (perception)
+        {
+            uint64 enemyGuid = enemy->GetGUID().GetRawValue();
+            for (std::size_t i = 0; i < perception->mobs.size(); ++i)
+            {
+                if (perception->mobs[i].guid == enemyGuid)
+                {
+                    threat.mobIndex = int32(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::size_t count = std::min<std::size_t>(_threat.size(), out.threat.size());
+    std::partial_sort(_threat.begin(), _threat.begin() + count, _threat.end(),
+        [](AIPlayerObservation::Threat const& a, AIPlayerObservation::Threat const& b) { return a.threat > b.threat; });
+    std::copy_n(_threat.begin(), count, out.threat.begin());
+}
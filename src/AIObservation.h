@@ -0,0 +1,69 @@
+/*
+ * Erweiterte Beobachtung pro Bot: Auren, Cooldowns, Cast-Fortschritt, Details
+ * zum Ziel und Threat.
+ *
+ * Gesammelt wird nur, solange ein Client eines der Beobachtungsfelder
+ * abonniert hat (AIControllerServer::GetObservationFields), und nur die
+ * abonnierten Felder. Die Cooldowns beziehen sich auf eine feste Spell-Liste
+ * aus AIController.Observation.Spells (für alle Klassen) bzw.
+ * AIController.Observation.Spells.<Klasse>, damit jede Position im Array
+ * immer denselben Spell meint.
+ */
+
+#ifndef MOD_AI_CONTROLLER_OBSERVATION_H
+#define MOD_AI_CONTROLLER_OBSERVATION_H
+
+#include "AIState.h"
+#include "Define.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+class Spell;
+struct AIBotPerception;
+
+class AIObservationCollector
+{
+public:
+    // OnAfterConfigLoad
+    void LoadSpells();
+
+    // Nur World-Thread; fields = Bits der Beobachtungsfelder (AIStateField)
+    void Collect(Player* player, uint32 fields, AIBotPerception const* perception, AIPlayerObservation& out);
+
+    // Nach jedem Snapshot: vergisst Casts von Bots, für die Collect diesmal nicht lief
+    void Prune(uint32 fields);
+
+    std::vector<uint32> const& GetSpells(uint8 classId) const;
+
+private:
+    struct CastTrack
+    {
+        Spell const* spell = nullptr;
+        uint32 spellId = 0;
+        uint32 startedAt = 0;       // getMSTime(), als der Cast zum ersten Mal gesehen wurde
+        uint32 generation = 0;      // _generation beim letzten Collect
+    };
+
+    void CollectAuras(Player* player, AIPlayerObservation& out) const;
+    void CollectCooldowns(Player* player, AIPlayerObservation& out) const;
+    void CollectCast(Player* player, AIPlayerObservation& out);
+    void CollectTarget(Player* player, AIPlayerObservation& out) const;
+    void CollectThreat(Player* player, AIBotPerception const* perception, AIPlayerObservation& out);
+
+    // "133,116,..." -> höchstens AI_OBS_COOLDOWN_SLOTS Spell-IDs; false bei ungültigem Eintrag
+    static bool ParseSpells(std::string const& text, std::vector<uint32>& out);
+
+    // Index = Klasse (CLASS_*), 0 ungenutzt
+    std::vector<std::vector<uint32>> _spells;
+
+    // Laufende Casts pro Bot (GUID); ein Bot ohne Cast hat keinen Eintrag
+    std::unordered_map<uint64, CastTrack> _casts;
+    uint32 _generation = 0;
+
+    // Wiederverwendeter Arbeitspuffer
+    std::vector<AIPlayerObservation::Threat> _threat;
+};
+
+#endif
@@ -0,0 +1,315 @@
+#include "AIPerception.h"
+#include "AIMetrics.h"
+#include "CellImpl.h"
+#include "Creature.h"
+#include "GridNotifiers.h"
+#include "GridNotifiersImpl.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+#include "Timer.h"
+#include <algorithm>
+
+namespace
+{
+    // Sammelt alle Kandidaten einer Zelle einmal; der Distanz-Filter passiert pro Bot
+    class CreatureCollector {
+    public:
+        AICreatureBlock& foundCreatures;
+        CreatureCollector(AICreatureBlock& out) : foundCreatures(out) {}
+
+        void Visit(CreatureMapType& m) {
+            for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr) {
+                Creature* creature = itr->GetSource();
+                if (creature) {
+                    if (!creature->IsInWorld()) continue;
+                    if (creature->IsTotem() || creature->IsPet()) continue;
+                    if (creature->GetCreatureTemplate()->type == CREATURE_TYPE_CRITTER) continue;
+
+                    foundCreatures.Add(creature);
+                }
+            }
+        }
+        template<class SKIP> void Visit(GridRefMgr<SKIP>&) {}
+    };
+
+    struct ScanKey
+    {
+        Map const* map;
+        uint32 cell;
+
+        bool operator<(ScanKey const& other) const
+        {
+            return map != other.map ? map < other.map : cell < other.cell;
+        }
+        bool operator==(ScanKey const& other) const { return map == other.map && cell == other.cell; }
+    };
+
+    ScanKey GetScanKey(Player* player)
+    {
+        return { player->GetMap(), Acore::ComputeCellCoord(player->GetPositionX(), player->GetPositionY()).GetId() };
+    }
+}
+
+// --- CREATURE BLOCK ---
+
+void AICreatureBlock::Clear()
+{
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _size.clear();
+    _alive.clear();
+    _creatures.clear();
+}
+
+void AICreatureBlock::Add(Creature* creature)
+{
+    _x.push_back(creature->GetPositionX());
+    _y.push_back(creature->GetPositionY());
+    _z.push_back(creature->GetPositionZ());
+    _size.push_back(creature->GetObjectSize());
+    _alive.push_back(creature->IsAlive() ? 1 : 0);
+    _creatures.push_back(creature);
+}
+
+void AICreatureBlock::Query(float x, float y, float z, float size, float aliveRange, float corpseRange, std::vector<uint32>& out)
+{
+    std::size_t count = _creatures.size();
+    _inRange.resize(count);
+
+    float const* cx = _x.data();
+    float const* cy = _y.data();
+    float const* cz = _z.data();
+    float const* cs = _size.data();
+    uint8 const* alive = _alive.data();
+    uint8* inRange = _inRange.data();
+
+    // Ohne Sprünge und ohne sqrt, damit die Schleife vektorisiert wird
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float dx = cx[i] - x;
+        float dy = cy[i] - y;
+        float dz = cz[i] - z;
+        float range = (alive[i] ? aliveRange : corpseRange) + size + cs[i];
+        inRange[i] = (dx * dx + dy * dy + dz * dz) < range * range;
+    }
+
+    out.clear();
+    for (std::size_t i = 0; i < count; ++i)
+        if (inRange[i])
+            out.push_back(uint32(i));
+}
+
+// --- CACHE ---
+
+AIPerceptionCache::AIPerceptionCache() : _cursor(0), _generation(0), _budgetCarry(0), _scanInterval(2000), _changed(false)
+{
+}
+
+void AIPerceptionCache::SetBots(std::vector<Player*> const& players)
+{
+    ++_generation;
+
+    // Wer in welcher Zelle steht, für das Mitscannen von Nachbarn
+    _cellBots.clear();
+    for (Player* player : players)
+    {
+        if (!player)
+            continue;
+
+        ScanKey key = GetScanKey(player);
+        _cellBots.push_back({ key.map, key.cell, player->GetGUID().GetRawValue() });
+    }
+    std::sort(_cellBots.begin(), _cellBots.end());
+
+    bool added = false;
+    for (Player* player : players)
+    {
+        if (!player)
+            continue;
+
+        auto result = _entries.try_emplace(player->GetGUID().GetRawValue());
+        result.first->second.lastSeen = _generation;
+        if (result.second)
+        {
+            _order.push_back(result.first->first);
+            added = true;
+        }
+    }
+
+    // Ausgeloggte Bots entfernen
+    if (!added && _entries.size() == players.size())
+        return;
+
+    for (auto itr = _entries.begin(); itr != _entries.end();)
+    {
+        if (itr->second.lastSeen != _generation)
+            itr = _entries.erase(itr);
+        else
+            ++itr;
+    }
+
+    _order.erase(std::remove_if(_order.begin(), _order.end(), [this](uint64 guid)
+    {
+        return _entries.find(guid) == _entries.end();
+    }), _order.end());
+
+    if (_cursor >= _order.size())
+        _cursor = 0;
+}
+
+void AIPerceptionCache::Update(uint32 diff)
+{
+    if (_order.empty())
+        return;
+
+    // So viele Scans, dass jeder Bot etwa einmal pro Scan-Intervall dran ist
+    _budgetCarry += uint32(_order.size()) * diff;
+    uint32 scans = std::min<uint32>(_budgetCarry / _scanInterval, MaxScansPerTick);
+    _budgetCarry = std::min<uint32>(_budgetCarry - scans * _scanInterval, _scanInterval * MaxScansPerTick);
+    scans = std::min<uint32>(scans, uint32(_order.size()));
+    if (!scans)
+        return;
+
+    uint32 now = getMSTime();
+    uint32 fresh = _scanInterval / 2;
+
+    _due.clear();
+    for (std::size_t visited = 0; _due.size() < scans && visited < _order.size(); ++visited)
+    {
+        uint64 guid = _order[_cursor];
+        _cursor = (_cursor + 1) % _order.size();
+
+        // Wurde schon mit einem Bot aus seiner Zelle gescannt
+        auto itr = _entries.find(guid);
+        if (itr != _entries.end() && itr->second.scannedAt && getMSTimeDiff(itr->second.scannedAt, now) < fresh)
+            continue;
+
+        Player* player = ObjectAccessor::FindPlayer(ObjectGuid(guid));
+        if (player && player->IsInWorld())
+            _due.push_back(player);
+    }
+
+    // Bots in derselben Zelle teilen sich einen Grid-Visit
+    std::sort(_due.begin(), _due.end(), [](Player* a, Player* b) { return GetScanKey(a) < GetScanKey(b); });
+
+    for (std::size_t i = 0; i < _due.size();)
+    {
+        ScanKey key = GetScanKey(_due[i]);
+        _group.clear();
+        while (i < _due.size() && GetScanKey(_due[i]) == key)
+            _group.push_back(_due[i++]);
+
+        AddCellmates(key.map, key.cell, now);
+        ScanGroup(_group, now);
+    }
+}
+
+void AIPerceptionCache::AddCellmates(Map const* map, uint32 cell, uint32 now)
+{
+    ScanKey key = { map, cell };
+    auto range = std::equal_range(_cellBots.begin(), _cellBots.end(), CellBot{ map, cell, 0 });
+
+    uint32 fresh = _scanInterval / 2;
+    for (auto itr = range.first; itr != range.second; ++itr)
+    {
+        auto entry = _entries.find(itr->guid);
+        if (entry == _entries.end() || (entry->second.scannedAt && getMSTimeDiff(entry->second.scannedAt, now) < fresh))
+            continue;
+
+        // Stand aus dem Snapshot-Tick; die Zelle kann sich seitdem geändert haben
+        Player* player = ObjectAccessor::FindPlayer(ObjectGuid(itr->guid));
+        if (!player || !player->IsInWorld() || !(GetScanKey(player) == key))
+            continue;
+        if (std::find(_group.begin(), _group.end(), player) == _group.end())
+            _group.push_back(player);
+    }
+}
+
+void AIPerceptionCache::ScanGroup(std::vector<Player*> const& group, uint32 now)
+{
+    Player* center = group.front();
+
+    float spread = 0.0f;
+    for (Player* bot : group)
+        spread = std::max(spread, center->GetExactDist2d(bot));
+
+    _block.Clear();
+    CreatureCollector collector(_block);
+    Cell::VisitObjects(center, collector, AliveRange + spread);
+    sAIMetrics->Add(AI_COUNTER_SCANS);
+
+    for (Player* bot : group)
+    {
+        auto itr = _entries.find(bot->GetGUID().GetRawValue());
+        if (itr == _entries.end())
+            continue;
+
+        BuildPerception(bot, itr->second);
+        itr->second.scannedAt = now;
+    }
+}
+
+void AIPerceptionCache::BuildPerception(Player* p, AIBotPerception& perception)
+{
+    perception.mobs.clear();
+    _scratchJson.clear();
+
+    // Erst in einen Zwischenpuffer, damit Änderungen erkannt werden (beide Puffer behalten ihre Kapazität)
+    AIJsonWriter mobJson(_scratchJson);
+    mobJson.Char('[');
+    bool firstMob = true;
+    _block.Query(p->GetPositionX(), p->GetPositionY(), p->GetPositionZ(), p->GetObjectSize(), AliveRange, CorpseRange, _hits);
+    for (uint32 index : _hits) {
+        Creature* c = _block.Get(index);
+
+        uint64 targetGuid = 0;
+        if (c->GetTarget()) targetGuid = c->GetTarget().GetRawValue();
+        bool attackable = p->IsValidAttackTarget(c);
+
+        if (!firstMob) mobJson.Raw(", ");
+        mobJson.Raw("{\"guid\": \""); mobJson.Number(c->GetGUID().GetRawValue());
+        mobJson.Raw("\", \"name\": "); mobJson.String(c->GetName());
+        mobJson.Raw(", \"level\": "); mobJson.Number(uint32(c->GetLevel()));
+        mobJson.Raw(", \"attackable\": "); mobJson.Raw(attackable ? "1" : "0");
+        mobJson.Raw(", \"vendor\": "); mobJson.Raw(c->IsVendor() ? "1" : "0");
+        mobJson.Raw(", \"target\": \""); mobJson.Number(targetGuid);
+        mobJson.Raw("\", \"hp\": "); mobJson.Number(c->GetHealth());
+        mobJson.Raw(", \"x\": "); mobJson.Number(c->GetPositionX());
+        mobJson.Raw(", \"y\": "); mobJson.Number(c->GetPositionY());
+        mobJson.Raw(", \"z\": "); mobJson.Number(c->GetPositionZ());
+        mobJson.Char('}');
+        firstMob = false;
+
+        AIMobRecord& mob = perception.mobs.emplace_back();
+        mob.guid = c->GetGUID().GetRawValue();
+        mob.entry = c->GetEntry();
+        mob.hp = c->GetHealth();
+        mob.target = targetGuid;
+        mob.x = c->GetPositionX(); mob.y = c->GetPositionY(); mob.z = c->GetPositionZ();
+        mob.level = c->GetLevel();
+        if (attackable) mob.flags |= AI_MOB_FLAG_ATTACKABLE;
+        if (c->IsVendor()) mob.flags |= AI_MOB_FLAG_VENDOR;
+        if (!c->IsAlive()) mob.flags |= AI_MOB_FLAG_DEAD;
+    }
+    mobJson.Char(']');
+
+    if (_scratchJson != perception.mobsJson)
+    {
+        perception.mobsJson.swap(_scratchJson);
+        _changed = true;
+    }
+}
+
+bool AIPerceptionCache::ConsumeChanged()
+{
+    bool changed = _changed;
+    _changed = false;
+    return changed;
+}
+
+AIBotPerception const* AIPerceptionCache::Get(uint64 guid) const
+{
+    auto itr = _entries.find(guid);
+    return itr != _entries.end() ? &itr->second : nullptr;
+}
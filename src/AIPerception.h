@@ -0,0 +1,114 @@
+/*
+ * Wahrnehmung pro Bot: welche Kreaturen sind in der Nähe.
+ *
+ * Jeder Bot hat einen eigenen Cache (Key = GUID). Die Grid-Scans werden über
+ * die Ticks verteilt (Round-Robin mit Budget). Ist ein Bot dran, wird seine
+ * ganze Map-Zelle gescannt: ein Cell::VisitObjects-Aufruf füllt einen
+ * Kreatur-Block (Structure of Arrays), und alle Bots der Zelle filtern ihn
+ * quadriert nach Distanz. Wer so mitgescannt wurde, wird im Round-Robin
+ * übersprungen, bis sein Intervall wieder halb um ist. Die Kosten wachsen
+ * damit mit der Zahl der Zellen statt mit Bots x Kreaturen.
+ */
+
+#ifndef MOD_AI_CONTROLLER_PERCEPTION_H
+#define MOD_AI_CONTROLLER_PERCEPTION_H
+
+#include "AIState.h"
+#include "Define.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Creature;
+class Map;
+class Player;
+
+struct AIBotPerception
+{
+    std::string mobsJson = "[]";
+    std::vector<AIMobRecord> mobs;
+    uint32 lastSeen = 0;        // Generation, in der der Bot zuletzt im Snapshot war
+    uint32 scannedAt = 0;       // getMSTime() des letzten Scans
+};
+
+// Kreaturen einer Zelle zum Zeitpunkt des Scans; die Distanz-Schleife läuft über
+// zusammenhängende float-Arrays und wird vom Compiler vektorisiert
+class AICreatureBlock
+{
+public:
+    void Clear();
+    void Add(Creature* creature);
+
+    // Indizes aller Kreaturen in Reichweite, wie WorldObject::IsWithinDist (mit Objektgrößen)
+    void Query(float x, float y, float z, float size, float aliveRange, float corpseRange, std::vector<uint32>& out);
+
+    Creature* Get(uint32 index) const { return _creatures[index]; }
+    std::size_t GetCount() const { return _creatures.size(); }
+
+private:
+    std::vector<float> _x, _y, _z, _size;
+    std::vector<uint8> _alive;
+    std::vector<uint8> _inRange;
+    std::vector<Creature*> _creatures;
+};
+
+class AIPerceptionCache
+{
+public:
+    AIPerceptionCache();
+
+    // Bots für die nächsten Scans festlegen (aus dem Snapshot-Tick)
+    void SetBots(std::vector<Player*> const& players);
+
+    // Jeden World-Tick: scannt so viele Bots, dass jeder etwa alle _scanInterval ms dran ist
+    void Update(uint32 diff);
+
+    AIBotPerception const* Get(uint64 guid) const;
+
+    // true, wenn sich seit dem letzten Aufruf die Mob-Liste eines Bots geändert hat
+    bool ConsumeChanged();
+
+    void SetScanInterval(uint32 interval) { _scanInterval = std::max<uint32>(interval, 1); }
+    uint32 GetScanInterval() const { return _scanInterval; }
+
+    static constexpr uint32 MaxScansPerTick = 64;
+    static constexpr float AliveRange = 50.0f;
+    static constexpr float CorpseRange = 10.0f;
+
+private:
+    struct CellBot
+    {
+        Map const* map;
+        uint32 cell;
+        uint64 guid;
+
+        bool operator<(CellBot const& other) const
+        {
+            return map != other.map ? map < other.map : cell < other.cell;
+        }
+    };
+
+    // Weitere Bots derselben Zelle in _group aufnehmen
+    void AddCellmates(Map const* map, uint32 cell, uint32 now);
+    void ScanGroup(std::vector<Player*> const& group, uint32 now);
+    void BuildPerception(Player* bot, AIBotPerception& perception);
+
+    std::unordered_map<uint64, AIBotPerception> _entries;
+    std::vector<uint64> _order;
+    std::size_t _cursor;
+    uint32 _generation;
+    uint32 _budgetCarry;
+    uint32 _scanInterval;
+    bool _changed;
+
+    // Wiederverwendete Arbeitspuffer
+    std::vector<Player*> _due;
+    std::vector<Player*> _group;
+    std::vector<CellBot> _cellBots;     // Nach Zelle sortiert, Stand des letzten SetBots
+    AICreatureBlock _block;
+    std::vector<uint32> _hits;
+    std::string _scratchJson;
+};
+
+#endif
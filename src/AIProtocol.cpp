@@ -0,0 +1,516 @@
+#include "AIProtocol.h"
+#include "AIController.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+
+namespace
+{
+    struct ActionName
+    {
+        std::string_view name;
+        AIAction action;
+    };
+
+    constexpr ActionName ActionNames[] =
+    {
+        { "say",            AI_ACTION_SAY },
+        { "stop",           AI_ACTION_STOP },
+        { "turn_left",      AI_ACTION_TURN_LEFT },
+        { "turn_right",     AI_ACTION_TURN_RIGHT },
+        { "move_forward",   AI_ACTION_MOVE_FORWARD },
+        { "target_nearest", AI_ACTION_TARGET_NEAREST },
+        { "cast",           AI_ACTION_CAST },
+        { "reset",          AI_ACTION_RESET },
+        { "move_to",        AI_ACTION_MOVE_TO },
+        { "target_guid",    AI_ACTION_TARGET_GUID },
+        { "loot_guid",      AI_ACTION_LOOT_GUID },
+        { "sell_grey",      AI_ACTION_SELL_GREY },
+        { "spawn",          AI_ACTION_SPAWN },
+        { "checkpoint",     AI_ACTION_CHECKPOINT },
+        { "reset_batch",    AI_ACTION_RESET_BATCH },
+        { "loot_all",       AI_ACTION_LOOT_ALL },
+        { "attack",         AI_ACTION_ATTACK },
+        { "vendor_run",     AI_ACTION_VENDOR_RUN }
+    };
+
+    constexpr char const* MacroStatusNames[MAX_AI_MACRO_STATUS] =
+    {
+        "done", "cancelled", "no_target", "unreachable", "timeout", "died"
+    };
+
+    template<class T>
+    bool ParseInteger(std::string_view text, T& out)
+    {
+        char const* end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, out);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    bool ParseFloat(std::string_view text, float& out)
+    {
+        // strtof wie zuvor std::stof, braucht aber einen nullterminierten String
+        std::string buffer(text);
+        char* end = nullptr;
+        out = std::strtof(buffer.c_str(), &end);
+        return !buffer.empty() && end == buffer.c_str() + buffer.size();
+    }
+}
+
+std::size_t AIByteWriter::BeginFrame(AIFrameType type)
+{
+    std::size_t start = _out.size();
+    U32(0);
+    U8(type);
+    return start;
+}
+
+void AIByteWriter::EndFrame(std::size_t frameStart)
+{
+    uint32 length = uint32(_out.size() - frameStart - AI_FRAME_HEADER_SIZE);
+    for (int i = 0; i < 4; ++i)
+        _out[frameStart + i] = char((length >> (8 * i)) & 0xFF);
+}
+
+std::string_view AIByteReader::Bytes(std::size_t length)
+{
+    if (_pos + length > _length)
+    {
+        _error = true;
+        return { };
+    }
+
+    std::string_view view(reinterpret_cast<char const*>(_data + _pos), length);
+    _pos += length;
+    return view;
+}
+
+// --- COMMANDS ---
+
+AIAction GetActionByName(std::string_view name)
+{
+    for (ActionName const& entry : ActionNames)
+        if (entry.name == name)
+            return entry.action;
+    return AI_ACTION_NONE;
+}
+
+char const* GetActionName(AIAction action)
+{
+    for (ActionName const& entry : ActionNames)
+        if (entry.action == action)
+            return entry.name.data();
+    return "none";
+}
+
+char const* GetMacroStatusName(AIMacroStatus status)
+{
+    return status < MAX_AI_MACRO_STATUS ? MacroStatusNames[status] : "unknown";
+}
+
+bool ParseTextCommand(std::string_view line, AICommand& cmd)
+{
+    // Format: playerName:actionType:value
+    std::size_t p1 = line.find(':');
+    if (p1 == std::string_view::npos)
+        return false;
+    std::size_t p2 = line.find(':', p1 + 1);
+    if (p2 == std::string_view::npos)
+        return false;
+
+    // "#handle" adressiert einen Bot über seinen Roster-Handle
+    std::string_view player = line.substr(0, p1);
+    if (!player.empty() && player[0] == '#')
+    {
+        if (!ParseInteger(player.substr(1), cmd.botHandle) || cmd.botHandle == AI_INVALID_BOT_HANDLE)
+            return false;
+    }
+    else
+        cmd.playerName = std::string(player);
+
+    // Action als Name oder direkt als AIAction-Nummer
+    std::string_view actionName = line.substr(p1 + 1, p2 - p1 - 1);
+    uint32 actionId = 0;
+    if (ParseInteger(actionName, actionId))
+        cmd.action = actionId < MAX_AI_ACTION ? AIAction(actionId) : AI_ACTION_NONE;
+    else
+        cmd.action = GetActionByName(actionName);
+    std::string_view value = line.substr(p2 + 1);
+
+    switch (cmd.action)
+    {
+        case AI_ACTION_NONE:
+            return false;
+        case AI_ACTION_SAY:
+            cmd.text = std::string(value);
+            return true;
+        case AI_ACTION_TARGET_NEAREST:
+        case AI_ACTION_LOOT_ALL:
+        case AI_ACTION_VENDOR_RUN:
+            // Ungültige/fehlende Range -> Default
+            if (!value.empty() && (!ParseFloat(value, cmd.range) || cmd.range <= 0.0f))
+                cmd.range = 0.0f;
+            return true;
+        case AI_ACTION_CAST:
+            return ParseInteger(value, cmd.spellId);
+        case AI_ACTION_MOVE_TO:
+        {
+            // Format: x:y:z
+            std::size_t v1 = value.find(':');
+            if (v1 == std::string_view::npos)
+                return false;
+            std::size_t v2 = value.find(':', v1 + 1);
+            if (v2 == std::string_view::npos)
+                return false;
+            return ParseFloat(value.substr(0, v1), cmd.x)
+                && ParseFloat(value.substr(v1 + 1, v2 - v1 - 1), cmd.y)
+                && ParseFloat(value.substr(v2 + 1), cmd.z);
+        }
+        case AI_ACTION_TARGET_GUID:
+        case AI_ACTION_LOOT_GUID:
+        case AI_ACTION_SELL_GREY:
+        case AI_ACTION_ATTACK:
+            return ParseInteger(value, cmd.targetGuid);
+        case AI_ACTION_RESET:
+            return value.empty() || ParseInteger(value, cmd.episodeId);
+        case AI_ACTION_RESET_BATCH:
+        {
+            // Format: episode[:handle,handle,...]
+            std::size_t v1 = value.find(':');
+            if (!ParseInteger(value.substr(0, v1), cmd.episodeId))
+                return false;
+            if (v1 == std::string_view::npos)
+                return true;
+
+            std::string_view handles = value.substr(v1 + 1);
+            while (!handles.empty())
+            {
+                std::size_t comma = handles.find(',');
+                uint32 handle = 0;
+                if (!ParseInteger(handles.substr(0, comma), handle) || cmd.botHandles.size() >= AI_MAX_STEP_COMMANDS)
+                    return false;
+                cmd.botHandles.push_back(handle);
+                handles = comma == std::string_view::npos ? std::string_view() : handles.substr(comma + 1);
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+bool DecodeBinaryCommand(AIFrameType type, char const* data, std::size_t length, AICommand& cmd)
+{
+    AIByteReader reader(data, length);
+    if (type == AI_FRAME_BOT_COMMAND)
+        cmd.botHandle = reader.U32();
+    else
+        cmd.playerGuid = reader.U64();
+    uint8 action = reader.U8();
+    if (reader.HasError() || action == AI_ACTION_NONE || action >= MAX_AI_ACTION)
+        return false;
+
+    cmd.action = AIAction(action);
+    switch (cmd.action)
+    {
+        case AI_ACTION_SAY:
+        {
+            uint16 textLength = reader.U16();
+            cmd.text = std::string(reader.Bytes(textLength));
+            break;
+        }
+        case AI_ACTION_TARGET_NEAREST:
+        case AI_ACTION_LOOT_ALL:
+        case AI_ACTION_VENDOR_RUN:
+            cmd.range = reader.F32();
+            if (!(cmd.range > 0.0f))
+                cmd.range = 0.0f;
+            break;
+        case AI_ACTION_CAST:
+            cmd.spellId = reader.U32();
+            break;
+        case AI_ACTION_MOVE_TO:
+            cmd.x = reader.F32();
+            cmd.y = reader.F32();
+            cmd.z = reader.F32();
+            break;
+        case AI_ACTION_TARGET_GUID:
+        case AI_ACTION_LOOT_GUID:
+        case AI_ACTION_SELL_GREY:
+        case AI_ACTION_ATTACK:
+            cmd.targetGuid = reader.U64();
+            break;
+        case AI_ACTION_RESET_BATCH:
+        {
+            cmd.episodeId = reader.U64();
+            uint16 count = reader.U16();
+            if (reader.HasError() || count > reader.Remaining() / 4)
+                return false;
+            cmd.botHandles.reserve(count);
+            for (uint16 i = 0; i < count; ++i)
+                cmd.botHandles.push_back(reader.U32());
+            return !reader.HasError();
+        }
+        default:
+            break;
+    }
+
+    return !reader.HasError() && (cmd.playerGuid != 0 || cmd.botHandle != AI_INVALID_BOT_HANDLE);
+}
+
+bool DecodeBinarySubscription(char const* data, std::size_t length, AISubscription& subscription)
+{
+    AIByteReader reader(data, length);
+    uint32 fields = reader.U32();
+    uint16 count = reader.U16();
+    if (reader.HasError() || count > reader.Remaining() / 8)
+        return false;
+
+    subscription.SetFields(fields ? fields : AISubscription::DefaultFields);
+    for (uint16 i = 0; i < count; ++i)
+    {
+        uint32 first = reader.U32();
+        uint32 last = reader.U32();
+        if (first > last)
+            return false;
+        subscription.AddHandles(first, last);
+    }
+    subscription.Finalize();
+    return !reader.HasError();
+}
+
+// --- STATE ---
+
+namespace
+{
+    // Feste Blöcke nach den Mobs eines Players, Reihenfolge = AIStateField
+    void WriteObservation(AIByteWriter& writer, AIPlayerObservation const& observation, uint32 fields)
+    {
+        if (fields & (1u << AI_FIELD_AURAS))
+        {
+            for (AIPlayerObservation::Aura const& aura : observation.auras)
+            {
+                writer.U32(aura.spellId);
+                writer.U32(uint32(aura.remainingMs));
+                writer.U8(aura.stacks);
+                writer.U8(aura.negative);
+                writer.Zero(2);
+            }
+        }
+        if (fields & (1u << AI_FIELD_COOLDOWNS))
+        {
+            writer.U8(observation.cooldownCount);
+            writer.Zero(3);
+            for (int32 cooldown : observation.cooldowns)
+                writer.U32(uint32(cooldown));
+        }
+        if (fields & (1u << AI_FIELD_CAST))
+        {
+            writer.U32(observation.castSpell);
+            writer.F32(observation.castProgress);
+            writer.U32(observation.castRemainingMs);
+            writer.U8(observation.castChanneled);
+            writer.Zero(3);
+        }
+        if (fields & (1u << AI_FIELD_TARGET_INFO))
+        {
+            writer.U8(observation.targetLevel);
+            writer.U8(observation.targetHostile);
+            writer.Zero(2);
+            writer.U32(observation.targetHp);
+            writer.U32(observation.targetMaxHp);
+            writer.U32(observation.targetPower);
+            writer.U32(observation.targetMaxPower);
+            writer.U32(observation.targetEntry);
+            writer.F32(observation.targetDistance);
+        }
+        if (fields & (1u << AI_FIELD_THREAT))
+        {
+            for (AIPlayerObservation::Threat const& threat : observation.threat)
+            {
+                writer.U16(uint16(int16(threat.mobIndex)));
+                writer.U8(threat.attackingMe);
+                writer.Zero(1);
+                writer.U32(threat.entry);
+                writer.F32(threat.threat);
+            }
+        }
+    }
+
+    uint32 GetObservationSize(uint32 fields)
+    {
+        uint32 size = 0;
+        if (fields & (1u << AI_FIELD_AURAS))
+            size += AI_OBS_AURA_SLOTS * AI_OBS_AURA_RECORD_SIZE;
+        if (fields & (1u << AI_FIELD_COOLDOWNS))
+            size += AI_OBS_COOLDOWNS_SIZE;
+        if (fields & (1u << AI_FIELD_CAST))
+            size += AI_OBS_CAST_SIZE;
+        if (fields & (1u << AI_FIELD_TARGET_INFO))
+            size += AI_OBS_TARGET_INFO_SIZE;
+        if (fields & (1u << AI_FIELD_THREAT))
+            size += AI_OBS_THREAT_SLOTS * AI_OBS_THREAT_RECORD_SIZE;
+        return size;
+    }
+}
+
+std::string EncodeBinaryState(AIStateSnapshot const& snapshot, AISubscription const* subscription)
+{
+    if (subscription && subscription->IsAll())
+        subscription = nullptr;
+    bool withMobs = !subscription || subscription->HasField(AI_FIELD_NEARBY_MOBS);
+    uint32 observationFields = subscription ? subscription->GetFields() & AISubscription::ObservationFields : 0;
+    bool withObservations = observationFields && snapshot.observations.size() == snapshot.players.size();
+    static AIPlayerObservation const noObservation;
+
+    // Die Zähler sind uint16; mehr Player bzw. Mobs werden abgeschnitten statt überzulaufen
+    uint32 playerCount = 0;
+    for (std::size_t i = 0; i < snapshot.players.size() && playerCount < 0xFFFF; ++i)
+        if (!subscription || subscription->Matches(snapshot, i))
+            ++playerCount;
+
+    std::string out;
+    out.reserve(AI_FRAME_HEADER_SIZE + 1 + 10 + playerCount * (AI_PLAYER_RECORD_SIZE + GetObservationSize(observationFields)) +
+        (withMobs ? snapshot.mobs.size() * AI_MOB_RECORD_SIZE : 0));
+
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_STATE);
+    writer.U64(snapshot.version);
+    writer.U16(uint16(playerCount));
+
+    uint32 written = 0;
+    for (std::size_t p = 0; p < snapshot.players.size() && written < playerCount; ++p)
+    {
+        if (subscription && !subscription->Matches(snapshot, p))
+            continue;
+
+        ++written;
+        AIPlayerRecord const& player = snapshot.players[p];
+        uint32 mobCount = withMobs ? std::min<uint32>(player.mobCount, 0xFFFF) : 0;
+        writer.U64(player.guid);
+        writer.Bytes(player.name, sizeof(player.name));
+        writer.U32(player.hp);
+        writer.U32(player.maxHp);
+        writer.U32(player.power);
+        writer.U32(player.maxPower);
+        writer.U8(player.level);
+        writer.U8(player.flags);
+        writer.U16(uint16(player.freeSlots));
+        writer.F32(player.x);
+        writer.F32(player.y);
+        writer.F32(player.z);
+        writer.F32(player.o);
+        writer.U8(player.targetStatus);
+        writer.Zero(3);
+        writer.U32(player.targetHp);
+        writer.F32(player.tx);
+        writer.F32(player.ty);
+        writer.F32(player.tz);
+        writer.U32(player.xpGained);
+        writer.U32(player.lootCopper);
+        writer.U32(player.lootScore);
+        writer.U16(uint16(mobCount));
+        writer.Zero(2);
+
+        for (uint32 i = 0; i < mobCount; ++i)
+        {
+            AIMobRecord const& mob = snapshot.mobs[player.mobOffset + i];
+            writer.U64(mob.guid);
+            writer.U32(mob.entry);
+            writer.U32(mob.hp);
+            writer.U64(mob.target);
+            writer.F32(mob.x);
+            writer.F32(mob.y);
+            writer.F32(mob.z);
+            writer.U8(mob.level);
+            writer.U8(mob.flags);
+            writer.Zero(2);
+        }
+
+        // Abonniert, aber (noch) nicht gesammelt: Blöcke mit 0, damit das Layout fest bleibt
+        if (observationFields)
+            WriteObservation(writer, withObservations ? snapshot.observations[p] : noObservation, observationFields);
+    }
+
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryHeartbeat(uint64 version)
+{
+    std::string out;
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_HEARTBEAT);
+    writer.U64(version);
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryStepAck(uint64 stepId, uint64 version, AIStepStatus status)
+{
+    std::string out;
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_STEP_ACK);
+    writer.U64(stepId);
+    writer.U64(version);
+    writer.U8(status);
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryEpisode(uint64 episodeId, uint64 version, uint16 bots, uint16 teleported)
+{
+    std::string out;
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_EPISODE);
+    writer.U64(episodeId);
+    writer.U64(version);
+    writer.U16(bots);
+    writer.U16(teleported);
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryMacro(AIMacroEvent const& macro, uint64 version)
+{
+    std::string out;
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_MACRO);
+    writer.U32(macro.handle);
+    writer.U64(macro.guid);
+    writer.U8(macro.action);
+    writer.U8(macro.status);
+    writer.U32(macro.value);
+    writer.U64(version);
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryMetrics(std::string_view report)
+{
+    std::string out;
+    out.reserve(AI_FRAME_HEADER_SIZE + 1 + report.size());
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_METRICS);
+    writer.Bytes(report.data(), report.size());
+    writer.EndFrame(frame);
+    return out;
+}
+
+std::string EncodeBinaryRoster(std::vector<AIRosterEntry> const& roster)
+{
+    std::string out;
+    out.reserve(AI_FRAME_HEADER_SIZE + 1 + 4 + roster.size() * AI_ROSTER_RECORD_SIZE);
+
+    AIByteWriter writer(out);
+    std::size_t frame = writer.BeginFrame(AI_FRAME_ROSTER);
+    writer.U32(uint32(roster.size()));
+    for (AIRosterEntry const& bot : roster)
+    {
+        writer.U32(bot.handle);
+        writer.U64(bot.guid);
+        writer.Bytes(bot.name, sizeof(bot.name));
+    }
+    writer.EndFrame(frame);
+    return out;
+}
@@ -0,0 +1,314 @@
+/*
+ * Wire-Protokoll zwischen Server und AI-Client.
+ *
+ * Text (Default, gut zum Debuggen):
+ *   Client -> Server: "playerName:actionType:value\n"
+ *                     "#handle:actionId:value\n" (Bot-Handle aus dem Roster,
+ *                     numerische Action, ohne Namens-Lookups)
+ *   Server -> Client: JSON-Zeilen (siehe AIState.h)
+ *
+ * Steps (für Lock-Step-Training): "@step <id>", bis zu AI_MAX_STEP_COMMANDS
+ * Kommandos, "@end"; ein Step mit mehr Kommandos wird ganz verworfen
+ * (AI_STEP_DROPPED). Der World-Thread wendet alle Kommandos eines Steps im selben Tick
+ * an und baut danach sofort einen Snapshot. Vor dem ersten State-Frame, der
+ * den Step enthält, kommt {"type": "step", "step": id, "version": V, ...}.
+ *
+ * Episoden: "checkpoint" merkt sich den Zustand eines Bots, "reset" stellt ihn
+ * wieder her (ohne Checkpoint: Homebind). "*:reset_batch:<episode>" setzt alle
+ * Bots zurück, "*:reset_batch:<episode>:1,4,7" nur diese Handles; auch
+ * "reset:<episode>" für einen Bot. Ist episode != 0, kommt vor dem nächsten
+ * State-Frame {"type": "episode", "episode": id, "version": V, "bots": n,
+ * "teleported": t} an die Verbindung, die den Reset geschickt hat.
+ *
+ * Makros: "loot_all[:range]" lootet alle erreichbaren Leichen (Default 30 Yards),
+ * "attack:<guid>" läuft zum Ziel und kämpft, bis es tot ist, "vendor_run[:range]"
+ * verkauft beim nächsten Händler (Default 100 Yards). Der World-Thread führt die
+ * Schritte selbst aus; am Ende kommt vor dem nächsten State-Frame
+ * {"type": "macro", "handle": h, "guid": "g", "macro": "loot_all", "status": s,
+ * "value": n, "version": V} an die Verbindung, die das Makro gestartet hat.
+ * value = geplünderte Leichen bzw. verdientes Kupfer.
+ *
+ * Subscription: "@subscribe <bots> [<fields>]" beschränkt State-Frames auf die
+ * eigenen Bots, z.B. "@subscribe 0-9,Bota vitals,position,nearby_mobs".
+ * "@subscribe *" bzw. "@unsubscribe" schaltet zurück auf alles (siehe
+ * AISubscription in AIState.h, binär AI_FRAME_SUBSCRIBE). Die Beobachtungsfelder
+ * (auras, cooldowns, cast, target_info, threat; Gruppe "observation") kommen nur,
+ * wenn sie ausdrücklich abonniert sind, z.B. "@subscribe * *,observation".
+ *
+ * Roster: Liste der steuerbaren Bots mit ihrem Handle. Kommt im Delta- und im
+ * Binärmodus automatisch beim Connect und bei jeder Änderung, im Full-Modus
+ * nach "@roster".
+ *
+ * Binär (Opt-in mit der Zeile "@binary\n" direkt nach dem Connect):
+ *   Jeder Frame: [uint32 Länge][uint8 Typ][Payload], Länge = 1 + Payload.
+ *   Alle Werte little-endian, Floats als IEEE-754 binary32.
+ *   Frames vom Client dürfen höchstens AI_MAX_CLIENT_FRAME_SIZE lang sein.
+ *   Frames vom Server haben keine Obergrenze: ein State-Frame mit 200 Bots ist
+ *   schon rund 100 KB groß.
+ *
+ *   AI_FRAME_STATE (Server -> Client)
+ *     uint64 version
+ *     uint16 playerCount (höchstens 65535, weitere Player fehlen im Frame)
+ *     playerCount x { Player-Record (AI_PLAYER_RECORD_SIZE), mobCount x Mob-Record (AI_MOB_RECORD_SIZE),
+ *                     Beobachtungsblöcke }
+ *
+ *   Player-Record:
+ *     uint64 guid, char name[12] (mit 0 aufgefüllt),
+ *     uint32 hp, max_hp, power, max_power,
+ *     uint8 level, uint8 flags (AIPlayerFlags), uint16 free_slots,
+ *     float x, y, z, o,
+ *     uint8 target_status (AITargetStatus), uint8 pad[3], uint32 target_hp,
+ *     float tx, ty, tz,
+ *     uint32 xp_gained, loot_copper, loot_score,
+ *     uint16 mobCount (höchstens 65535), uint16 pad
+ *
+ *   Mob-Record:
+ *     uint64 guid, uint32 entry, uint32 hp, uint64 target,
+ *     float x, y, z, uint8 level, uint8 flags (AIMobFlags), uint16 pad
+ *
+ *   Beobachtungsblöcke: nur die abonnierten Beobachtungsfelder, in dieser
+ *   Reihenfolge und immer in voller Breite (leere Slots 0):
+ *     auras         AI_OBS_AURA_SLOTS x { uint32 spell, int32 remaining_ms (-1 = ohne Ablauf),
+ *                   uint8 stacks, uint8 negative, uint16 pad }
+ *     cooldowns     uint8 count, uint8 pad[3], AI_OBS_COOLDOWN_SLOTS x int32 ms (-1 = Spell unbekannt)
+ *     cast          uint32 spell, float progress (0..1), uint32 remaining_ms, uint8 channeled, uint8 pad[3]
+ *     target_info   uint8 level, uint8 hostile, uint16 pad, uint32 hp, max_hp, power, max_power, entry,
+ *                   float distance
+ *     threat        AI_OBS_THREAT_SLOTS x { int16 mob_index (-1 = nicht in den Mobs des Players),
+ *                   uint8 attacking_me, uint8 pad, uint32 entry, float threat }
+ *
+ *   AI_FRAME_HEARTBEAT (Server -> Client)
+ *     uint64 version
+ *
+ *   AI_FRAME_STEP_BEGIN (Client -> Server)
+ *     uint64 stepId. Alle Kommandos bis AI_FRAME_STEP_END bilden einen Step.
+ *
+ *   AI_FRAME_STEP_END (Client -> Server)
+ *     keine Payload
+ *
+ *   AI_FRAME_STEP_ACK (Server -> Client, direkt vor dem State-Frame)
+ *     uint64 stepId, uint64 version, uint8 status (AIStepStatus)
+ *
+ *   AI_FRAME_EPISODE (Server -> Client, direkt vor dem State-Frame)
+ *     uint64 episodeId, uint64 version, uint16 bots, uint16 teleported
+ *
+ *   AI_FRAME_MACRO (Server -> Client, direkt vor dem State-Frame)
+ *     uint32 handle, uint64 guid, uint8 action (AIAction), uint8 status (AIMacroStatus),
+ *     uint32 value, uint64 version
+ *
+ *   AI_FRAME_SUBSCRIBE (Client -> Server)
+ *     uint32 fieldMask (Bit = AIStateField, 0 = Standardfelder ohne Beobachtungen),
+ *     uint16 count, count x { uint32 firstHandle, uint32 lastHandle } (count 0 = alle Bots).
+ *     Ohne nearby_mobs im fieldMask ist mobCount immer 0; die Player-Records
+ *     selbst bleiben vollständig.
+ *
+ *   AI_FRAME_METRICS (beide Richtungen)
+ *     Client -> Server: keine Payload, fordert den Report an
+ *     Server -> Client: Report als Text (Zeilen "name wert" bzw.
+ *                       "name count=.. avg=.. p50=.. p99=.. max=..")
+ *
+ *   AI_FRAME_ROSTER (Server -> Client)
+ *     uint32 botCount, botCount x { uint32 handle, uint64 guid, char name[12] }
+ *     Namen sind UTF-8, mit 0 aufgefüllt und nur an Zeichengrenzen gekürzt.
+ *
+ *   AI_FRAME_COMMAND (Client -> Server)
+ *     uint64 playerGuid, uint8 action (AIAction), Argumente (siehe unten)
+ *
+ *   AI_FRAME_BOT_COMMAND (Client -> Server)
+ *     uint32 handle, uint8 action (AIAction), Argumente je nach Action:
+ *       AI_ACTION_SAY             uint16 len, char text[len]
+ *       AI_ACTION_TARGET_NEAREST,
+ *       AI_ACTION_LOOT_ALL,
+ *       AI_ACTION_VENDOR_RUN      float range (<= 0 = Default)
+ *       AI_ACTION_CAST            uint32 spellId
+ *       AI_ACTION_MOVE_TO         float x, y, z
+ *       AI_ACTION_TARGET_GUID,
+ *       AI_ACTION_LOOT_GUID,
+ *       AI_ACTION_SELL_GREY,
+ *       AI_ACTION_ATTACK          uint64 guid
+ *       AI_ACTION_SPAWN           keine, playerGuid = Charakter-GUID
+ *       AI_ACTION_RESET_BATCH     uint64 episodeId, uint16 count, count x uint32 handle
+ *                                 (count 0 = alle Bots; handle/playerGuid davor wird ignoriert)
+ *       alle anderen              keine
+ */
+
+#ifndef MOD_AI_CONTROLLER_PROTOCOL_H
+#define MOD_AI_CONTROLLER_PROTOCOL_H
+
+#include "Define.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct AICommand;
+struct AIMacroEvent;
+class AISubscription;
+struct AIRosterEntry;
+struct AIStateSnapshot;
+
+enum AIAction : uint8
+{
+    AI_ACTION_NONE              = 0,
+    AI_ACTION_SAY               = 1,
+    AI_ACTION_STOP              = 2,
+    AI_ACTION_TURN_LEFT         = 3,
+    AI_ACTION_TURN_RIGHT        = 4,
+    AI_ACTION_MOVE_FORWARD      = 5,
+    AI_ACTION_TARGET_NEAREST    = 6,
+    AI_ACTION_CAST              = 7,
+    AI_ACTION_RESET             = 8,
+    AI_ACTION_MOVE_TO           = 9,
+    AI_ACTION_TARGET_GUID       = 10,
+    AI_ACTION_LOOT_GUID         = 11,
+    AI_ACTION_SELL_GREY         = 12,
+    AI_ACTION_SPAWN             = 13,   // Bot einloggen (Name bzw. Charakter-GUID), kein Wert
+    AI_ACTION_CHECKPOINT        = 14,   // Aktuellen Zustand als Ziel für reset merken
+    AI_ACTION_RESET_BATCH       = 15,   // Mehrere Bots auf einmal zurücksetzen, Bot-Feld wird ignoriert
+    AI_ACTION_LOOT_ALL          = 16,   // Makro: alle Leichen in Reichweite looten
+    AI_ACTION_ATTACK            = 17,   // Makro: hinlaufen und kämpfen, bis das Ziel tot ist
+    AI_ACTION_VENDOR_RUN        = 18,   // Makro: zum nächsten Händler laufen und verkaufen
+    MAX_AI_ACTION
+};
+
+enum AIFrameType : uint8
+{
+    AI_FRAME_STATE          = 1,
+    AI_FRAME_HEARTBEAT      = 2,
+    AI_FRAME_COMMAND        = 3,
+    AI_FRAME_ROSTER         = 4,
+    AI_FRAME_BOT_COMMAND    = 5,
+    AI_FRAME_STEP_BEGIN     = 6,
+    AI_FRAME_STEP_END       = 7,
+    AI_FRAME_STEP_ACK       = 8,
+    AI_FRAME_EPISODE        = 9,
+    AI_FRAME_MACRO          = 10,
+    AI_FRAME_SUBSCRIBE      = 11,
+    AI_FRAME_METRICS        = 12
+};
+
+enum AIStepStatus : uint8
+{
+    AI_STEP_APPLIED,
+    AI_STEP_DROPPED     // Command-Queue voll oder mehr als AI_MAX_STEP_COMMANDS, nichts wurde angewendet
+};
+
+enum AIMacroStatus : uint8
+{
+    AI_MACRO_DONE,
+    AI_MACRO_CANCELLED,     // Neues Makro, Reset oder Bewegungs-/Kampf-Kommando für denselben Bot
+    AI_MACRO_NO_TARGET,     // Kein Ziel gefunden oder Ziel verschwunden
+    AI_MACRO_UNREACHABLE,   // Ziel nach mehreren Wegen nicht erreicht
+    AI_MACRO_TIMEOUT,       // AIController.Macro.Timeout überschritten
+    AI_MACRO_DIED,
+    MAX_AI_MACRO_STATUS
+};
+
+constexpr uint32 AI_FRAME_HEADER_SIZE       = 4;
+constexpr uint32 AI_MAX_CLIENT_FRAME_SIZE   = 64 * 1024;    // Nur Client -> Server (Frame bzw. Textzeile)
+constexpr uint32 AI_PLAYER_RECORD_SIZE      = 92;
+constexpr uint32 AI_MOB_RECORD_SIZE         = 40;
+constexpr uint32 AI_ROSTER_RECORD_SIZE      = 24;
+constexpr uint32 AI_INVALID_BOT_HANDLE      = 0xFFFFFFFF;
+constexpr uint32 AI_MAX_STEP_COMMANDS       = 1024;
+
+// Beobachtungsblöcke im AI_FRAME_STATE
+constexpr uint32 AI_OBS_AURA_RECORD_SIZE    = 12;
+constexpr uint32 AI_OBS_COOLDOWNS_SIZE      = 68;
+constexpr uint32 AI_OBS_CAST_SIZE           = 16;
+constexpr uint32 AI_OBS_TARGET_INFO_SIZE    = 28;
+constexpr uint32 AI_OBS_THREAT_RECORD_SIZE  = 12;
+
+// --- LITTLE-ENDIAN HELPER ---
+
+class AIByteWriter
+{
+public:
+    explicit AIByteWriter(std::string& out) : _out(out) { }
+
+    void U8(uint8 v) { _out.push_back(char(v)); }
+    void U16(uint16 v) { Put(v, 2); }
+    void U32(uint32 v) { Put(v, 4); }
+    void U64(uint64 v) { Put(v, 8); }
+    void F32(float v) { uint32 bits; std::memcpy(&bits, &v, 4); U32(bits); }
+    void Bytes(char const* data, std::size_t length) { _out.append(data, length); }
+    void Zero(std::size_t count) { _out.append(count, '\0'); }
+
+    std::size_t Size() const { return _out.size(); }
+
+    // Länge eines mit BeginFrame begonnenen Frames nachtragen
+    std::size_t BeginFrame(AIFrameType type);
+    void EndFrame(std::size_t frameStart);
+
+private:
+    void Put(uint64 v, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            _out.push_back(char((v >> (8 * i)) & 0xFF));
+    }
+
+    std::string& _out;
+};
+
+class AIByteReader
+{
+public:
+    AIByteReader(char const* data, std::size_t length) : _data(reinterpret_cast<uint8 const*>(data)), _length(length), _pos(0), _error(false) { }
+
+    uint8 U8() { return uint8(Get(1)); }
+    uint16 U16() { return uint16(Get(2)); }
+    uint32 U32() { return uint32(Get(4)); }
+    uint64 U64() { return Get(8); }
+    float F32() { uint32 bits = U32(); float v; std::memcpy(&v, &bits, 4); return v; }
+    std::string_view Bytes(std::size_t length);
+
+    bool HasError() const { return _error; }
+    std::size_t Remaining() const { return _length - _pos; }
+
+private:
+    uint64 Get(int bytes)
+    {
+        if (_pos + bytes > _length)
+        {
+            _error = true;
+            return 0;
+        }
+        uint64 v = 0;
+        for (int i = 0; i < bytes; ++i)
+            v |= uint64(_data[_pos + i]) << (8 * i);
+        _pos += bytes;
+        return v;
+    }
+
+    uint8 const* _data;
+    std::size_t _length;
+    std::size_t _pos;
+    bool _error;
+};
+
+// --- COMMANDS ---
+
+AIAction GetActionByName(std::string_view name);
+char const* GetActionName(AIAction action);
+char const* GetMacroStatusName(AIMacroStatus status);
+
+// "playerName:actionType:value" -> AICommand. false bei ungültiger Zeile.
+bool ParseTextCommand(std::string_view line, AICommand& cmd);
+
+// Payload eines AI_FRAME_COMMAND/AI_FRAME_BOT_COMMAND (ohne Länge/Typ) -> AICommand
+bool DecodeBinaryCommand(AIFrameType type, char const* data, std::size_t length, AICommand& cmd);
+
+// Payload eines AI_FRAME_SUBSCRIBE -> fertige (Finalize) Subscription
+bool DecodeBinarySubscription(char const* data, std::size_t length, AISubscription& subscription);
+
+// --- STATE ---
+
+std::string EncodeBinaryState(AIStateSnapshot const& snapshot, AISubscription const* subscription = nullptr);
+std::string EncodeBinaryHeartbeat(uint64 version);
+std::string EncodeBinaryStepAck(uint64 stepId, uint64 version, AIStepStatus status);
+std::string EncodeBinaryEpisode(uint64 episodeId, uint64 version, uint16 bots, uint16 teleported);
+std::string EncodeBinaryMacro(AIMacroEvent const& macro, uint64 version);
+std::string EncodeBinaryMetrics(std::string_view report);
+std::string EncodeBinaryRoster(std::vector<AIRosterEntry> const& roster);
+
+#endif
@@ -0,0 +1,713 @@
+#include "AIState.h"
+#include "AIProtocol.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+
+char const* const AIStateFieldNames[MAX_AI_STATE_FIELDS] =
+{
+    "hp", "max_hp", "power", "max_power", "level",
+    "x", "y", "z", "o",
+    "combat", "casting", "free_slots", "equipped_upgrade",
+    "target_status", "target_hp",
+    "xp_gained", "loot_copper", "loot_score", "leveled_up",
+    "tx", "ty", "tz",
+    "nearby_mobs",
+    "auras", "cooldowns", "cast", "target_info", "threat"
+};
+
+// --- SUBSCRIPTION ---
+
+namespace
+{
+    struct FieldGroup
+    {
+        std::string_view name;
+        uint32 mask;
+    };
+
+    constexpr uint32 FieldBit(AIStateField field) { return 1u << field; }
+
+    constexpr FieldGroup FieldGroups[] =
+    {
+        { "vitals",     FieldBit(AI_FIELD_HP) | FieldBit(AI_FIELD_MAX_HP) | FieldBit(AI_FIELD_POWER) | FieldBit(AI_FIELD_MAX_POWER) | FieldBit(AI_FIELD_LEVEL) },
+        { "position",   FieldBit(AI_FIELD_X) | FieldBit(AI_FIELD_Y) | FieldBit(AI_FIELD_Z) | FieldBit(AI_FIELD_O) },
+        { "state",      FieldBit(AI_FIELD_COMBAT) | FieldBit(AI_FIELD_CASTING) | FieldBit(AI_FIELD_FREE_SLOTS) },
+        { "target",     FieldBit(AI_FIELD_TARGET_STATUS) | FieldBit(AI_FIELD_TARGET_HP) | FieldBit(AI_FIELD_TX) | FieldBit(AI_FIELD_TY) | FieldBit(AI_FIELD_TZ) },
+        { "rewards",    FieldBit(AI_FIELD_EQUIPPED_UPGRADE) | FieldBit(AI_FIELD_XP_GAINED) | FieldBit(AI_FIELD_LOOT_COPPER) | FieldBit(AI_FIELD_LOOT_SCORE) | FieldBit(AI_FIELD_LEVELED_UP) },
+        { "observation", AISubscription::ObservationFields },
+        { "*",          AISubscription::DefaultFields }
+    };
+
+    // Liste "a,b,c" mit Leerzeichen um die Einträge
+    template<class Visitor>
+    bool ForEachEntry(std::string_view list, Visitor&& visitor)
+    {
+        while (!list.empty())
+        {
+            std::size_t comma = list.find(',');
+            std::string_view entry = TrimSpaces(list.substr(0, comma));
+            if (entry.empty() || !visitor(entry))
+                return false;
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        }
+        return true;
+    }
+
+    bool ParseHandle(std::string_view text, uint32& out)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), out);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+}
+
+bool AISubscription::Parse(std::string_view text)
+{
+    text = TrimSpaces(text);
+    std::size_t space = text.find(' ');
+    std::string_view bots = text.substr(0, space);
+    std::string_view fields = space == std::string_view::npos ? std::string_view() : TrimSpaces(text.substr(space + 1));
+
+    _allBots = bots.empty() || bots == "*";
+    _handles.clear();
+    _names.clear();
+    _fields = DefaultFields;
+
+    if (!_allBots && !ForEachEntry(bots, [this](std::string_view entry)
+    {
+        if (entry.front() == '#')
+            entry.remove_prefix(1);
+
+        uint32 first = 0, last = 0;
+        std::size_t dash = entry.find('-');
+        if (dash != std::string_view::npos && ParseHandle(entry.substr(0, dash), first) && ParseHandle(entry.substr(dash + 1), last))
+        {
+            if (first > last)
+                return false;
+            AddHandles(first, last);
+        }
+        else if (ParseHandle(entry, first))
+            AddHandles(first, first);
+        else
+        {
+            std::string name;
+            AIJsonWriter(name).String(entry);
+            _names.push_back(std::move(name));
+        }
+        return true;
+    }))
+        return false;
+
+    if (!fields.empty() && fields != "*")
+    {
+        _fields = 0;
+        if (!ForEachEntry(fields, [this](std::string_view entry)
+        {
+            for (FieldGroup const& group : FieldGroups)
+            {
+                if (group.name == entry)
+                {
+                    _fields |= group.mask;
+                    return true;
+                }
+            }
+            for (uint8 f = 0; f < MAX_AI_STATE_FIELDS; ++f)
+            {
+                if (entry == AIStateFieldNames[f])
+                {
+                    _fields |= 1u << f;
+                    return true;
+                }
+            }
+            return false;
+        }))
+            return false;
+    }
+
+    Finalize();
+    return true;
+}
+
+void AISubscription::AddHandles(uint32 first, uint32 last)
+{
+    _allBots = false;
+    _handles.emplace_back(first, last);
+}
+
+void AISubscription::Finalize()
+{
+    // Gleiche Auswahl in anderer Reihenfolge ergibt denselben Key
+    std::sort(_handles.begin(), _handles.end());
+    _handles.erase(std::unique(_handles.begin(), _handles.end()), _handles.end());
+    std::sort(_names.begin(), _names.end());
+    _names.erase(std::unique(_names.begin(), _names.end()), _names.end());
+
+    _key.clear();
+    AIJsonWriter writer(_key);
+    writer.Number(_fields);
+    if (_allBots)
+    {
+        writer.Raw("|*");
+        return;
+    }
+    for (auto const& [first, last] : _handles)
+    {
+        writer.Char('|'); writer.Number(first);
+        writer.Char('-'); writer.Number(last);
+    }
+    for (std::string const& name : _names)
+    {
+        writer.Char('|');
+        writer.Raw(name);
+    }
+}
+
+bool AISubscription::Matches(AIStateSnapshot const& snapshot, std::size_t player) const
+{
+    if (_allBots)
+        return true;
+
+    uint32 handle = snapshot.players[player].handle;
+    for (auto const& [first, last] : _handles)
+        if (handle >= first && handle <= last)
+            return true;
+
+    if (!_names.empty())
+    {
+        std::string_view name = snapshot.GetName(player);
+        for (std::string const& wanted : _names)
+            if (wanted == name)
+                return true;
+    }
+    return false;
+}
+
+// --- JSON WRITER ---
+
+void AIJsonWriter::String(std::string_view value)
+{
+    _out.push_back('"');
+    for (char c : value)
+    {
+        if (c == '\n')
+        {
+            _out += "\\n";
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            _out.push_back('\\');
+        _out.push_back(c);
+    }
+    _out.push_back('"');
+}
+
+// --- BUILDER ---
+
+AIStateBuilder::AIStateBuilder() : _nextBuffer(0), _valueStart(0), _nextField(0), _firstPlayer(true)
+{
+    Begin();
+}
+
+std::shared_ptr<AIStateSnapshot> AIStateBuilder::AcquireBuffer()
+{
+    for (std::size_t i = 0; i < BufferCount; ++i)
+    {
+        std::size_t index = (_nextBuffer + i) % BufferCount;
+        std::shared_ptr<AIStateSnapshot>& buffer = _buffers[index];
+
+        if (!buffer)
+        {
+            buffer = std::make_shared<AIStateSnapshot>();
+            buffer->json.reserve(InitialCapacity);
+        }
+        else if (buffer.use_count() != 1)
+            continue;
+
+        // Nur noch wir halten den Puffer, alle Leser sind fertig
+        std::atomic_thread_fence(std::memory_order_acquire);
+        _nextBuffer = (index + 1) % BufferCount;
+        return buffer;
+    }
+
+    // Beide Puffer noch bei (langsamen) Clients: Slot ersetzen, der alte
+    // Snapshot wird freigegeben, sobald der letzte Client ihn loslässt.
+    std::shared_ptr<AIStateSnapshot>& buffer = _buffers[_nextBuffer];
+    buffer = std::make_shared<AIStateSnapshot>();
+    buffer->json.reserve(InitialCapacity);
+    _nextBuffer = (_nextBuffer + 1) % BufferCount;
+    return buffer;
+}
+
+void AIStateBuilder::Begin(uint32 observationFields)
+{
+    _snapshot = AcquireBuffer();
+    _snapshot->version = 0;
+    _snapshot->json.clear();
+    _snapshot->names.clear();
+    _snapshot->fields.clear();
+    _snapshot->players.clear();
+    _snapshot->mobs.clear();
+    _snapshot->observationFields = observationFields & AISubscription::ObservationFields;
+    _snapshot->observationJson.clear();
+    _snapshot->observations.clear();
+    _snapshot->steps.clear();
+    _snapshot->episodes.clear();
+    _snapshot->macros.clear();
+
+    _firstPlayer = true;
+    _nextField = 0;
+
+    Writer().Raw("{ \"players\": [");
+    _snapshot->body.offset = Writer().Size();
+}
+
+void AIStateBuilder::BeginPlayer(std::string_view name)
+{
+    AIJsonWriter writer = Writer();
+    if (!_firstPlayer)
+        writer.Raw(", ");
+    _firstPlayer = false;
+
+    writer.Raw("{\"name\": ");
+    AIStateSnapshot::Span span;
+    span.offset = writer.Size();
+    writer.String(name);
+    span.length = writer.Size() - span.offset;
+    _snapshot->names.push_back(span);
+
+    _nextField = 0;
+}
+
+void AIStateBuilder::EndPlayer()
+{
+    // Fehlende Felder leer lassen, damit der Index pro Player gleich groß bleibt
+    while (_nextField < MAX_AI_STATE_FIELDS)
+    {
+        _snapshot->fields.emplace_back();
+        ++_nextField;
+    }
+    Writer().Char('}');
+}
+
+void AIStateBuilder::BeginValue(AIStateField field)
+{
+    while (_nextField < field)
+    {
+        _snapshot->fields.emplace_back();
+        ++_nextField;
+    }
+
+    AIJsonWriter writer = Writer();
+    writer.Raw(", \"");
+    writer.Raw(AIStateFieldNames[field]);
+    writer.Raw("\": ");
+    _valueStart = writer.Size();
+}
+
+void AIStateBuilder::EndValue()
+{
+    AIStateSnapshot::Span span;
+    span.offset = _valueStart;
+    span.length = Writer().Size() - _valueStart;
+    _snapshot->fields.push_back(span);
+    ++_nextField;
+}
+
+void AIStateBuilder::BeginObservationValue(AIStateField field)
+{
+    while (_nextField < field)
+    {
+        _snapshot->fields.emplace_back();
+        ++_nextField;
+    }
+    _valueStart = uint32(_snapshot->observationJson.size());
+}
+
+void AIStateBuilder::EndObservationValue()
+{
+    AIStateSnapshot::Span span;
+    span.offset = _valueStart;
+    span.length = uint32(_snapshot->observationJson.size()) - _valueStart;
+    _snapshot->fields.push_back(span);
+    ++_nextField;
+}
+
+void AIStateBuilder::AddObservation(AIPlayerObservation const& observation)
+{
+    uint32 wanted = _snapshot->observationFields;
+    AIJsonWriter writer(_snapshot->observationJson);
+
+    // [[spell, stacks, remaining_ms, negative], ...], immer AI_OBS_AURA_SLOTS Zeilen
+    if (wanted & (1u << AI_FIELD_AURAS))
+    {
+        BeginObservationValue(AI_FIELD_AURAS);
+        writer.Char('[');
+        for (std::size_t i = 0; i < observation.auras.size(); ++i)
+        {
+            AIPlayerObservation::Aura const& aura = observation.auras[i];
+            writer.Raw(i ? ", [" : "[");
+            writer.Number(aura.spellId); writer.Raw(", ");
+            writer.Number(uint32(aura.stacks)); writer.Raw(", ");
+            writer.Number(aura.remainingMs);
+            writer.Raw(aura.negative ? ", true]" : ", false]");
+        }
+        writer.Char(']');
+        EndObservationValue();
+    }
+
+    // [ms, ...] in der Reihenfolge von AIController.Observation.Spells
+    if (wanted & (1u << AI_FIELD_COOLDOWNS))
+    {
+        BeginObservationValue(AI_FIELD_COOLDOWNS);
+        writer.Char('[');
+        for (uint8 i = 0; i < observation.cooldownCount; ++i)
+        {
+            if (i)
+                writer.Raw(", ");
+            writer.Number(observation.cooldowns[i]);
+        }
+        writer.Char(']');
+        EndObservationValue();
+    }
+
+    // [spell, progress, remaining_ms, channeled]
+    if (wanted & (1u << AI_FIELD_CAST))
+    {
+        BeginObservationValue(AI_FIELD_CAST);
+        writer.Char('[');
+        writer.Number(observation.castSpell); writer.Raw(", ");
+        writer.Number(observation.castProgress); writer.Raw(", ");
+        writer.Number(observation.castRemainingMs);
+        writer.Raw(observation.castChanneled ? ", true]" : ", false]");
+        EndObservationValue();
+    }
+
+    // [level, hp, max_hp, power, max_power, entry, distance, hostile]
+    if (wanted & (1u << AI_FIELD_TARGET_INFO))
+    {
+        BeginObservationValue(AI_FIELD_TARGET_INFO);
+        writer.Char('[');
+        writer.Number(uint32(observation.targetLevel)); writer.Raw(", ");
+        writer.Number(observation.targetHp); writer.Raw(", ");
+        writer.Number(observation.targetMaxHp); writer.Raw(", ");
+        writer.Number(observation.targetPower); writer.Raw(", ");
+        writer.Number(observation.targetMaxPower); writer.Raw(", ");
+        writer.Number(observation.targetEntry); writer.Raw(", ");
+        writer.Number(observation.targetDistance);
+        writer.Raw(observation.targetHostile ? ", true]" : ", false]");
+        EndObservationValue();
+    }
+
+    // [[mob_index, entry, threat, attacking_me], ...], immer AI_OBS_THREAT_SLOTS Zeilen
+    if (wanted & (1u << AI_FIELD_THREAT))
+    {
+        BeginObservationValue(AI_FIELD_THREAT);
+        writer.Char('[');
+        for (std::size_t i = 0; i < observation.threat.size(); ++i)
+        {
+            AIPlayerObservation::Threat const& threat = observation.threat[i];
+            writer.Raw(i ? ", [" : "[");
+            writer.Number(threat.mobIndex); writer.Raw(", ");
+            writer.Number(threat.entry); writer.Raw(", ");
+            writer.Number(threat.threat);
+            writer.Raw(threat.attackingMe ? ", true]" : ", false]");
+        }
+        writer.Char(']');
+        EndObservationValue();
+    }
+}
+
+void AIStateBuilder::Bool(AIStateField field, bool value)
+{
+    BeginValue(field);
+    Writer().Raw(value ? "\"true\"" : "\"false\"");
+    EndValue();
+}
+
+void AIStateBuilder::String(AIStateField field, std::string_view value)
+{
+    BeginValue(field);
+    Writer().String(value);
+    EndValue();
+}
+
+void AIStateBuilder::Raw(AIStateField field, std::string_view json)
+{
+    BeginValue(field);
+    Writer().Raw(json);
+    EndValue();
+}
+
+void AIStateBuilder::AddPlayer(std::string_view name, AIPlayerRecord const& record, std::string_view mobsJson, std::vector<AIMobRecord> const& mobs,
+    AIPlayerObservation const* observation)
+{
+    static char const* const TargetStatusNames[] = { "none", "alive", "dead" };
+
+    BeginPlayer(name);
+    Number(AI_FIELD_HP, record.hp);
+    Number(AI_FIELD_MAX_HP, record.maxHp);
+    Number(AI_FIELD_POWER, record.power);
+    Number(AI_FIELD_MAX_POWER, record.maxPower);
+    Number(AI_FIELD_LEVEL, uint32(record.level));
+    Number(AI_FIELD_X, record.x);
+    Number(AI_FIELD_Y, record.y);
+    Number(AI_FIELD_Z, record.z);
+    Number(AI_FIELD_O, record.o);
+    Bool(AI_FIELD_COMBAT, record.flags & AI_PLAYER_FLAG_COMBAT);
+    Bool(AI_FIELD_CASTING, record.flags & AI_PLAYER_FLAG_CASTING);
+    Number(AI_FIELD_FREE_SLOTS, record.freeSlots);
+    Bool(AI_FIELD_EQUIPPED_UPGRADE, record.flags & AI_PLAYER_FLAG_EQUIPPED_UPGRADE);
+    String(AI_FIELD_TARGET_STATUS, TargetStatusNames[record.targetStatus]);
+    Number(AI_FIELD_TARGET_HP, record.targetHp);
+    Number(AI_FIELD_XP_GAINED, record.xpGained);
+    Number(AI_FIELD_LOOT_COPPER, record.lootCopper);
+    Number(AI_FIELD_LOOT_SCORE, record.lootScore);
+    Bool(AI_FIELD_LEVELED_UP, record.flags & AI_PLAYER_FLAG_LEVELED_UP);
+    Number(AI_FIELD_TX, record.tx);
+    Number(AI_FIELD_TY, record.ty);
+    Number(AI_FIELD_TZ, record.tz);
+    Raw(AI_FIELD_NEARBY_MOBS, mobsJson.empty() ? std::string_view("[]") : mobsJson);
+
+    // Die typisierten Beobachtungen bleiben parallel zu players, auch für Player ohne Daten
+    if (_snapshot->observationFields)
+    {
+        static AIPlayerObservation const empty;
+        AIPlayerObservation const& stored = _snapshot->observations.emplace_back(observation ? *observation : empty);
+        AddObservation(stored);
+    }
+    EndPlayer();
+
+    AIPlayerRecord& stored = _snapshot->players.emplace_back(record);
+    CopyRecordName(stored.name, name);
+    stored.mobOffset = uint32(_snapshot->mobs.size());
+    stored.mobCount = uint32(mobs.size());
+    _snapshot->mobs.insert(_snapshot->mobs.end(), mobs.begin(), mobs.end());
+}
+
+AIStateSnapshotPtr AIStateBuilder::Finish(uint64 version)
+{
+    _snapshot->body.length = Writer().Size() - _snapshot->body.offset;
+    Writer().Raw("] }\n");
+    _snapshot->version = version;
+
+    // Der Pool behält seine Referenz, der Aufrufer bekommt eine unveränderliche Sicht
+    AIStateSnapshotPtr result = std::move(_snapshot);
+    _snapshot.reset();
+    return result;
+}
+
+// --- FRAMES ---
+
+namespace
+{
+    // Inhalt von "players": [ ... ]; ohne Subscription direkt aus dem Dokument
+    void AppendPlayers(std::string& frame, AIStateSnapshot const& current, AISubscription const* subscription)
+    {
+        if (!subscription || subscription->IsAll())
+        {
+            frame += current.Slice(current.body);
+            return;
+        }
+
+        bool firstPlayer = true;
+        for (std::size_t i = 0; i < current.GetPlayerCount(); ++i)
+        {
+            if (!subscription->Matches(current, i))
+                continue;
+
+            if (!firstPlayer)
+                frame += ", ";
+            firstPlayer = false;
+            frame += "{\"name\": ";
+            frame += current.GetName(i);
+            for (uint8 f = 0; f < MAX_AI_STATE_FIELDS; ++f)
+            {
+                AIStateField field = AIStateField(f);
+                std::string_view value = current.GetValue(i, field);
+                if (value.empty() || !subscription->HasField(field))
+                    continue;
+                frame += ", \"";
+                frame += AIStateFieldNames[field];
+                frame += "\": ";
+                frame += value;
+            }
+            frame += "}";
+        }
+    }
+}
+
+std::string BuildFullFrame(AIStateSnapshot const& current, AISubscription const& subscription)
+{
+    std::string frame;
+    frame.reserve(256);
+    frame += "{ \"players\": [";
+    AppendPlayers(frame, current, &subscription);
+    frame += "] }\n";
+    return frame;
+}
+
+std::string BuildKeyframe(AIStateSnapshot const& current, AISubscription const* subscription)
+{
+    std::string frame;
+    frame.reserve(current.body.length + 64);
+    frame += "{\"type\": \"keyframe\", \"version\": ";
+    frame += std::to_string(current.version);
+    frame += ", \"players\": [";
+    AppendPlayers(frame, current, subscription);
+    frame += "]}\n";
+    return frame;
+}
+
+std::string BuildDeltaFrame(AIStateSnapshot const& base, AIStateSnapshot const& current, AISubscription const* subscription)
+{
+    if (subscription && subscription->IsAll())
+        subscription = nullptr;
+    uint32 fields = subscription ? subscription->GetFields() : AISubscription::DefaultFields;
+
+    std::unordered_map<std::string_view, std::size_t> baseIndex;
+    baseIndex.reserve(base.GetPlayerCount());
+    for (std::size_t i = 0; i < base.GetPlayerCount(); ++i)
+        baseIndex.emplace(base.GetName(i), i);
+
+    std::string frame;
+    frame += "{\"type\": \"delta\", \"version\": ";
+    frame += std::to_string(current.version);
+    frame += ", \"base\": ";
+    frame += std::to_string(base.version);
+    frame += ", \"players\": [";
+
+    bool firstPlayer = true;
+    for (std::size_t i = 0; i < current.GetPlayerCount(); ++i)
+    {
+        std::string_view name = current.GetName(i);
+        auto itr = baseIndex.find(name);
+        std::size_t baseSlot = itr != baseIndex.end() ? itr->second : base.GetPlayerCount();
+        if (itr != baseIndex.end())
+            baseIndex.erase(itr);
+        if (subscription && !subscription->Matches(current, i))
+            continue;
+
+        bool wroteName = false;
+        for (uint8 f = 0; f < MAX_AI_STATE_FIELDS; ++f)
+        {
+            AIStateField field = AIStateField(f);
+            std::string_view value = current.GetValue(i, field);
+            if (value.empty() || !(fields & (1u << field)))
+                continue;
+            if (baseSlot < base.GetPlayerCount() && base.GetValue(baseSlot, field) == value)
+                continue;
+
+            if (!wroteName)
+            {
+                if (!firstPlayer)
+                    frame += ", ";
+                firstPlayer = false;
+                frame += "{\"name\": ";
+                frame += name;
+                wroteName = true;
+            }
+
+            frame += ", \"";
+            frame += AIStateFieldNames[field];
+            frame += "\": ";
+            frame += value;
+        }
+
+        if (wroteName)
+            frame += "}";
+    }
+
+    frame += "], \"removed\": [";
+
+    // Was jetzt noch im Index steht, ist nicht mehr online
+    bool firstRemoved = true;
+    for (std::size_t i = 0; i < base.GetPlayerCount(); ++i)
+    {
+        if (baseIndex.find(base.GetName(i)) == baseIndex.end())
+            continue;
+        if (subscription && !subscription->Matches(base, i))
+            continue;
+
+        if (!firstRemoved)
+            frame += ", ";
+        firstRemoved = false;
+        frame += base.GetName(i);
+    }
+
+    frame += "]}\n";
+    return frame;
+}
+
+std::string BuildHeartbeat(uint64 version)
+{
+    return "{\"type\": \"heartbeat\", \"version\": " + std::to_string(version) + "}\n";
+}
+
+std::string BuildStepAck(uint64 stepId, uint64 version, bool applied)
+{
+    std::string frame;
+    AIJsonWriter writer(frame);
+    writer.Raw("{\"type\": \"step\", \"step\": "); writer.Number(stepId);
+    writer.Raw(", \"version\": "); writer.Number(version);
+    writer.Raw(applied ? ", \"status\": \"applied\"}\n" : ", \"status\": \"dropped\"}\n");
+    return frame;
+}
+
+std::string BuildEpisodeEvent(AIEpisodeEvent const& episode, uint64 version)
+{
+    std::string frame;
+    AIJsonWriter writer(frame);
+    writer.Raw("{\"type\": \"episode\", \"episode\": "); writer.Number(episode.episode);
+    writer.Raw(", \"version\": "); writer.Number(version);
+    writer.Raw(", \"bots\": "); writer.Number(episode.bots);
+    writer.Raw(", \"teleported\": "); writer.Number(episode.teleported);
+    writer.Raw("}\n");
+    return frame;
+}
+
+std::string BuildMacroEvent(AIMacroEvent const& macro, uint64 version)
+{
+    std::string frame;
+    AIJsonWriter writer(frame);
+    writer.Raw("{\"type\": \"macro\", \"handle\": "); writer.Number(macro.handle);
+    writer.Raw(", \"guid\": \""); writer.Number(macro.guid);
+    writer.Raw("\", \"macro\": "); writer.String(GetActionName(AIAction(macro.action)));
+    writer.Raw(", \"status\": "); writer.String(GetMacroStatusName(AIMacroStatus(macro.status)));
+    writer.Raw(", \"value\": "); writer.Number(macro.value);
+    writer.Raw(", \"version\": "); writer.Number(version);
+    writer.Raw("}\n");
+    return frame;
+}
+
+std::string BuildMetricsFrame(std::string_view report)
+{
+    std::string frame;
+    frame.reserve(report.size() + 48);
+    AIJsonWriter writer(frame);
+    writer.Raw("{\"type\": \"metrics\", \"text\": ");
+    writer.String(report);
+    writer.Raw("}\n");
+    return frame;
+}
+
+std::string BuildRosterFrame(std::vector<AIRosterEntry> const& roster)
+{
+    std::string frame;
+    frame.reserve(32 + roster.size() * 64);
+
+    AIJsonWriter writer(frame);
+    writer.Raw("{\"type\": \"roster\", \"bots\": [");
+    for (std::size_t i = 0; i < roster.size(); ++i)
+    {
+        AIRosterEntry const& bot = roster[i];
+        if (i)
+            writer.Raw(", ");
+        writer.Raw("{\"handle\": "); writer.Number(bot.handle);
+        writer.Raw(", \"name\": "); writer.String(std::string_view(bot.name, strnlen(bot.name, sizeof(bot.name))));
+        writer.Raw(", \"guid\": \""); writer.Number(bot.guid);
+        writer.Raw("\"}");
+    }
+    writer.Raw("]}\n");
+    return frame;
+}
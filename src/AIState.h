@@ -0,0 +1,429 @@
+/*
+ * State-Snapshots für den Socket-Stream.
+ *
+ * Ein Snapshot enthält das komplette JSON-Dokument (Legacy-Format, das jeder
+ * Client versteht) plus einen Index auf die Werte jedes Players. Über den Index
+ * werden Delta-Frames gebaut, ohne das JSON erneut zu parsen.
+ */
+
+#ifndef MOD_AI_CONTROLLER_STATE_H
+#define MOD_AI_CONTROLLER_STATE_H
+
+#include "Define.h"
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Reihenfolge = Reihenfolge im JSON
+enum AIStateField : uint8
+{
+    AI_FIELD_HP,
+    AI_FIELD_MAX_HP,
+    AI_FIELD_POWER,
+    AI_FIELD_MAX_POWER,
+    AI_FIELD_LEVEL,
+    AI_FIELD_X,
+    AI_FIELD_Y,
+    AI_FIELD_Z,
+    AI_FIELD_O,
+    AI_FIELD_COMBAT,
+    AI_FIELD_CASTING,
+    AI_FIELD_FREE_SLOTS,
+    AI_FIELD_EQUIPPED_UPGRADE,
+    AI_FIELD_TARGET_STATUS,
+    AI_FIELD_TARGET_HP,
+    AI_FIELD_XP_GAINED,
+    AI_FIELD_LOOT_COPPER,
+    AI_FIELD_LOOT_SCORE,
+    AI_FIELD_LEVELED_UP,
+    AI_FIELD_TX,
+    AI_FIELD_TY,
+    AI_FIELD_TZ,
+    AI_FIELD_NEARBY_MOBS,
+
+    // Beobachtungsfelder (AIPlayerObservation): nur für Clients, die sie
+    // abonnieren, und nur gesammelt, solange jemand sie abonniert hat
+    AI_FIELD_AURAS,
+    AI_FIELD_COOLDOWNS,
+    AI_FIELD_CAST,
+    AI_FIELD_TARGET_INFO,
+    AI_FIELD_THREAT,
+    MAX_AI_STATE_FIELDS
+};
+
+constexpr AIStateField AI_FIRST_OBSERVATION_FIELD = AI_FIELD_AURAS;
+
+extern char const* const AIStateFieldNames[MAX_AI_STATE_FIELDS];
+
+enum AITargetStatus : uint8
+{
+    AI_TARGET_NONE,
+    AI_TARGET_ALIVE,
+    AI_TARGET_DEAD
+};
+
+enum AIPlayerFlags : uint8
+{
+    AI_PLAYER_FLAG_COMBAT           = 0x01,
+    AI_PLAYER_FLAG_CASTING          = 0x02,
+    AI_PLAYER_FLAG_EQUIPPED_UPGRADE = 0x04,
+    AI_PLAYER_FLAG_LEVELED_UP       = 0x08
+};
+
+enum AIMobFlags : uint8
+{
+    AI_MOB_FLAG_ATTACKABLE  = 0x01,
+    AI_MOB_FLAG_VENDOR      = 0x02,
+    AI_MOB_FLAG_DEAD        = 0x04
+};
+
+// Name in ein festes Feld (mit 0 aufgefüllt); UTF-8 wird nur an Zeichengrenzen gekürzt
+template<std::size_t N>
+inline void CopyRecordName(char (&out)[N], std::string_view name)
+{
+    std::size_t length = name.size();
+    if (length > N)
+    {
+        length = N;
+        while (length && (uint8(name[length]) & 0xC0) == 0x80)
+            --length;
+    }
+    std::memset(out, 0, N);
+    std::memcpy(out, name.data(), length);
+}
+
+// Leerzeichen am Anfang und Ende entfernen (Listen aus Config und Protokoll)
+inline std::string_view TrimSpaces(std::string_view text)
+{
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+    return text;
+}
+
+// Typisierte Werte, aus denen sowohl JSON als auch das Binärformat entstehen
+struct AIMobRecord
+{
+    uint64 guid = 0;
+    uint32 entry = 0;
+    uint32 hp = 0;
+    uint64 target = 0;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    uint8 level = 0;
+    uint8 flags = 0;
+};
+
+struct AIPlayerRecord
+{
+    uint64 guid = 0;
+    uint32 handle = 0xFFFFFFFF;         // Roster-Handle, AI_INVALID_BOT_HANDLE für beobachtete Menschen
+    char name[12] = { };
+    uint32 hp = 0, maxHp = 0, power = 0, maxPower = 0;
+    uint8 level = 0;
+    uint8 flags = 0;
+    uint32 freeSlots = 0;
+    float x = 0.0f, y = 0.0f, z = 0.0f, o = 0.0f;
+    AITargetStatus targetStatus = AI_TARGET_NONE;
+    uint32 targetHp = 0;
+    float tx = 0.0f, ty = 0.0f, tz = 0.0f;
+    uint32 xpGained = 0, lootCopper = 0, lootScore = 0;
+
+    // Bereich in AIStateSnapshot::mobs
+    uint32 mobOffset = 0, mobCount = 0;
+};
+
+constexpr uint32 AI_OBS_AURA_SLOTS       = 16;
+constexpr uint32 AI_OBS_COOLDOWN_SLOTS   = 16;
+constexpr uint32 AI_OBS_THREAT_SLOTS     = 8;
+
+// Erweiterte Beobachtung eines Players; Arrays mit fester Breite, leere Slots mit Defaults
+struct AIPlayerObservation
+{
+    struct Aura
+    {
+        uint32 spellId = 0;
+        int32 remainingMs = 0;          // -1 = ohne Ablauf
+        uint8 stacks = 0;
+        bool negative = false;
+    };
+
+    struct Threat
+    {
+        int32 mobIndex = -1;            // Index in nearby_mobs des Players, -1 = nicht in der Liste
+        uint32 entry = 0;
+        float threat = 0.0f;
+        bool attackingMe = false;
+    };
+
+    std::array<Aura, AI_OBS_AURA_SLOTS> auras = { };
+
+    // Reihenfolge = AIController.Observation.Spells; ms bis bereit, -1 = Spell unbekannt
+    uint8 cooldownCount = 0;
+    std::array<int32, AI_OBS_COOLDOWN_SLOTS> cooldowns = { };
+
+    uint32 castSpell = 0;
+    float castProgress = 0.0f;          // 0..1
+    uint32 castRemainingMs = 0;
+    bool castChanneled = false;
+
+    uint8 targetLevel = 0;
+    bool targetHostile = false;
+    uint32 targetHp = 0, targetMaxHp = 0, targetPower = 0, targetMaxPower = 0;
+    uint32 targetEntry = 0;             // 0 = Player
+    float targetDistance = 0.0f;
+
+    // Höchster Threat zuerst
+    std::array<Threat, AI_OBS_THREAT_SLOTS> threat = { };
+};
+
+// Ein steuerbarer Bot im Roster
+struct AIRosterEntry
+{
+    uint32 handle = 0;
+    uint64 guid = 0;
+    char name[12] = { };
+};
+
+// Ein im Snapshot-Zeitraum angewendeter Step, gehört zu genau einer Client-Session
+struct AIStepAck
+{
+    uint32 session = 0;
+    uint64 step = 0;
+};
+
+// Abgeschlossener Reset mit Episode-ID, gehört wie ein Step zu einer Client-Session
+struct AIEpisodeEvent
+{
+    uint32 session = 0;
+    uint64 episode = 0;
+    uint16 bots = 0;            // Zurückgesetzte Bots
+    uint16 teleported = 0;      // Davon per TeleportTo (andere Map)
+};
+
+// Beendetes Makro eines Bots, gehört zu der Session, die es gestartet hat
+struct AIMacroEvent
+{
+    uint32 session = 0;
+    uint32 handle = 0;
+    uint64 guid = 0;
+    uint8 action = 0;           // AIAction
+    uint8 status = 0;           // AIMacroStatus
+    uint32 value = 0;           // loot_all: Leichen, vendor_run: Kupfer
+};
+
+struct AIStateSnapshot
+{
+    struct Span
+    {
+        uint32 offset = 0;
+        uint32 length = 0;
+    };
+
+    uint64 version = 0;
+
+    // Komplettes Dokument inkl. abschließendem '\n'
+    std::string json;
+
+    // Inhalt von "players": [ ... ] ohne die Klammern
+    Span body;
+
+    // Pro Player: Name (als JSON-String inkl. Quotes) und MAX_AI_STATE_FIELDS Werte
+    std::vector<Span> names;
+    std::vector<Span> fields;
+
+    // Typisierte Kopie für das Binärprotokoll
+    std::vector<AIPlayerRecord> players;
+    std::vector<AIMobRecord> mobs;
+
+    // Beobachtungsfelder: Werte in observationJson (nicht im Dokument), typisiert
+    // parallel zu players; beides nur, wenn observationFields nicht 0 ist
+    uint32 observationFields = 0;
+    std::string observationJson;
+    std::vector<AIPlayerObservation> observations;
+
+    // Seit dem letzten Snapshot angewendete Steps (nicht im JSON, jede Session bestätigt ihre eigenen)
+    std::vector<AIStepAck> steps;
+
+    // Seit dem letzten Snapshot abgeschlossene Resets (ebenfalls nicht im JSON)
+    std::vector<AIEpisodeEvent> episodes;
+
+    // Seit dem letzten Snapshot beendete Makros (ebenfalls nicht im JSON)
+    std::vector<AIMacroEvent> macros;
+
+    std::size_t GetPlayerCount() const { return names.size(); }
+    std::string_view Slice(Span span) const { return std::string_view(json).substr(span.offset, span.length); }
+    std::string_view GetName(std::size_t player) const { return Slice(names[player]); }
+    std::string_view GetValue(std::size_t player, AIStateField field) const
+    {
+        Span span = fields[player * MAX_AI_STATE_FIELDS + field];
+        return field < AI_FIRST_OBSERVATION_FIELD ? Slice(span) : std::string_view(observationJson).substr(span.offset, span.length);
+    }
+};
+
+using AIStateSnapshotPtr = std::shared_ptr<AIStateSnapshot const>;
+
+static_assert(MAX_AI_STATE_FIELDS <= 32, "AISubscription-Feldmaske ist uint32");
+
+// Auswahl eines Clients: welche Player und welche Felder er bekommt. Ohne
+// Subscription gehen alle Player mit den Standardfeldern raus (bisheriges
+// Verhalten), Beobachtungsfelder nur auf ausdrücklichen Wunsch.
+// Sessions mit gleichem Key teilen sich die fertig kodierten Frames.
+class AISubscription
+{
+public:
+    static constexpr uint32 AllFields = (1u << MAX_AI_STATE_FIELDS) - 1;
+    static constexpr uint32 DefaultFields = (1u << AI_FIRST_OBSERVATION_FIELD) - 1;
+    static constexpr uint32 ObservationFields = AllFields & ~DefaultFields;
+
+    // "<bots> [<fields>]"
+    //   bots   = "*" oder Liste aus Handles ("3", "#3"), Bereichen ("0-9") und Namen
+    //   fields = "*" oder Liste aus Feldnamen, Gruppen (vitals, position, state,
+    //            target, rewards, observation) und "*" für die Standardfelder;
+    //            fehlt sie, gelten die Standardfelder
+    // false bei ungültigem Eintrag
+    bool Parse(std::string_view text);
+
+    // Für das Binärprotokoll; danach Finalize
+    void AddHandles(uint32 first, uint32 last);
+    void SetFields(uint32 mask) { _fields = mask & AllFields; }
+    void Finalize();
+
+    bool IsAll() const { return _allBots && _fields == DefaultFields; }
+    bool Matches(AIStateSnapshot const& snapshot, std::size_t player) const;
+    bool HasField(AIStateField field) const { return _fields & (1u << field); }
+    uint32 GetFields() const { return _fields; }
+
+    std::string const& GetKey() const { return _key; }
+
+private:
+    bool _allBots = true;
+    std::vector<std::pair<uint32, uint32>> _handles;    // Inklusive Bereiche
+    std::vector<std::string> _names;                    // Als JSON-String inkl. Quotes, wie im Snapshot-Index
+    uint32 _fields = DefaultFields;
+    std::string _key;
+};
+
+// Schreibt JSON-Werte ohne Locale und ohne temporäre Strings direkt in einen Puffer
+class AIJsonWriter
+{
+public:
+    explicit AIJsonWriter(std::string& out) : _out(out) { }
+
+    void Raw(std::string_view text) { _out.append(text); }
+    void Char(char c) { _out.push_back(c); }
+    void String(std::string_view value);
+
+    template<class T>
+    void Number(T value)
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        _out.append(buffer, result.ptr - buffer);
+    }
+
+    uint32 Size() const { return uint32(_out.size()); }
+
+private:
+    std::string& _out;
+};
+
+// Baut einen Snapshot auf: JSON-Dokument, Feld-Index und typisierte Records.
+//
+// Der Builder lebt über alle Ticks. Er schreibt abwechselnd in zwei Puffer und
+// nimmt einen Puffer erst wieder, wenn kein Client mehr eine Referenz darauf
+// hält. Im eingeschwungenen Zustand gibt es damit keine Heap-Allokationen mehr.
+class AIStateBuilder
+{
+public:
+    AIStateBuilder();
+
+    // observationFields: welche Beobachtungsfelder AddPlayer schreibt
+    void Begin(uint32 observationFields = 0);
+
+    // mobsJson wird 1:1 als "nearby_mobs" übernommen; observation nur mit observationFields
+    void AddPlayer(std::string_view name, AIPlayerRecord const& record, std::string_view mobsJson, std::vector<AIMobRecord> const& mobs,
+        AIPlayerObservation const* observation = nullptr);
+
+    void AddStep(AIStepAck const& step) { _snapshot->steps.push_back(step); }
+    void AddEpisode(AIEpisodeEvent const& episode) { _snapshot->episodes.push_back(episode); }
+    void AddMacro(AIMacroEvent const& macro) { _snapshot->macros.push_back(macro); }
+
+    AIStateSnapshotPtr Finish(uint64 version);
+
+private:
+    std::shared_ptr<AIStateSnapshot> AcquireBuffer();
+
+    void BeginPlayer(std::string_view name);
+    void EndPlayer();
+
+    template<class T>
+    void Number(AIStateField field, T value)
+    {
+        BeginValue(field);
+        Writer().Number(value);
+        EndValue();
+    }
+
+    // Legacy: Bools werden als "true"/"false" Strings gesendet
+    void Bool(AIStateField field, bool value);
+    void String(AIStateField field, std::string_view value);
+    void Raw(AIStateField field, std::string_view json);
+
+    void BeginValue(AIStateField field);
+    void EndValue();
+
+    // Beobachtungsfelder landen ohne Key in observationJson
+    void AddObservation(AIPlayerObservation const& observation);
+    void BeginObservationValue(AIStateField field);
+    void EndObservationValue();
+
+    AIJsonWriter Writer() { return AIJsonWriter(_snapshot->json); }
+
+    static constexpr std::size_t BufferCount = 2;
+    static constexpr std::size_t InitialCapacity = 64 * 1024;
+
+    std::array<std::shared_ptr<AIStateSnapshot>, BufferCount> _buffers;
+    std::size_t _nextBuffer;
+
+    std::shared_ptr<AIStateSnapshot> _snapshot;
+    uint32 _valueStart;
+    uint8 _nextField;
+    bool _firstPlayer;
+};
+
+// --- FRAMES ---
+
+// Die Builder nehmen optional eine Subscription; nullptr = alle Player, Standardfelder
+
+// { "players": [...] } wie AIStateSnapshot::json, nur die abonnierten Player/Felder
+std::string BuildFullFrame(AIStateSnapshot const& current, AISubscription const& subscription);
+
+// {"type": "keyframe", "version": N, "players": [...]}
+std::string BuildKeyframe(AIStateSnapshot const& current, AISubscription const* subscription = nullptr);
+
+// Nur geänderte Player/Felder gegenüber base, plus entfernte Player
+std::string BuildDeltaFrame(AIStateSnapshot const& base, AIStateSnapshot const& current, AISubscription const* subscription = nullptr);
+
+// {"type": "heartbeat", "version": N}
+std::string BuildHeartbeat(uint64 version);
+
+// {"type": "step", "step": N, "version": V, "status": "applied"|"dropped"}
+std::string BuildStepAck(uint64 stepId, uint64 version, bool applied);
+
+// {"type": "episode", "episode": N, "version": V, "bots": n, "teleported": t}
+std::string BuildEpisodeEvent(AIEpisodeEvent const& episode, uint64 version);
+
+// {"type": "macro", "handle": h, "guid": "g", "macro": "loot_all", "status": "done", "value": n, "version": V}
+std::string BuildMacroEvent(AIMacroEvent const& macro, uint64 version);
+
+// {"type": "metrics", "text": "..."} mit dem Report aus AIControllerServer::BuildMetricsReport
+std::string BuildMetricsFrame(std::string_view report);
+
+// {"type": "roster", "bots": [{"handle": N, "name": "...", "guid": "..."}, ...]}
+std::string BuildRosterFrame(std::vector<AIRosterEntry> const& roster);
+
+#endif
@@ -0,0 +1,430 @@
+#include "AITrajectory.h"
+#include "AIController.h"
+#include "Log.h"
+#include "StringFormat.h"
+#include <algorithm>
+#include <bit>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+static_assert(std::endian::native == std::endian::little, "Trajektorien werden ohne Umwandlung geschrieben");
+
+namespace
+{
+    constexpr char TrajectoryMagic[8] = { 'A', 'I', 'T', 'R', 'A', 'J', '0', '1' };
+    constexpr std::size_t BlockHeaderSize = 24;
+    constexpr uint64 MinSegmentSize = 1024 * 1024;
+
+    constexpr std::size_t Align8(std::size_t size)
+    {
+        return (size + 7) & ~std::size_t(7);
+    }
+
+    template<class T>
+    void Put(uint8*& out, T value)
+    {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+
+    // Zählt nur, damit Reserve die genaue Größe kennt
+    class AIColumnSizer
+    {
+    public:
+        template<class Source, class Get>
+        void Column(std::vector<Source> const& values, Get get)
+        {
+            using T = std::remove_cvref_t<decltype(get(std::declval<Source const&>()))>;
+            _size += Align8(values.size() * sizeof(T));
+        }
+
+        std::size_t Size() const { return _size; }
+
+    private:
+        std::size_t _size = 0;
+    };
+
+    // Schreibt eine Spalte direkt in die gemappte Datei, Auffüllbytes sind schon 0
+    class AIColumnWriter
+    {
+    public:
+        explicit AIColumnWriter(uint8* out) : _out(out) { }
+
+        template<class Source, class Get>
+        void Column(std::vector<Source> const& values, Get get)
+        {
+            using T = std::remove_cvref_t<decltype(get(std::declval<Source const&>()))>;
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                T value = get(values[i]);
+                std::memcpy(_out + i * sizeof(T), &value, sizeof(T));
+            }
+            _out += Align8(values.size() * sizeof(T));
+        }
+
+    private:
+        uint8* _out;
+    };
+
+    // Reihenfolge und Typen wie im Header von AITrajectory.h
+    template<class Columns>
+    void StateColumns(Columns& columns, AIStateSnapshot const& snapshot)
+    {
+        std::vector<AIPlayerRecord> const& players = snapshot.players;
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.guid; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.handle; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.hp; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.maxHp; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.power; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.maxPower; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.level; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.flags; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.freeSlots; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.x; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.y; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.z; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.o; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return uint8(p.targetStatus); });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.targetHp; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.tx; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.ty; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.tz; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.xpGained; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.lootCopper; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.lootScore; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.mobOffset; });
+        columns.Column(players, [](AIPlayerRecord const& p) { return p.mobCount; });
+
+        std::vector<AIMobRecord> const& mobs = snapshot.mobs;
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.guid; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.entry; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.hp; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.target; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.x; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.y; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.z; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.level; });
+        columns.Column(mobs, [](AIMobRecord const& m) { return m.flags; });
+    }
+
+    template<class Columns>
+    void CommandColumns(Columns& columns, std::vector<AITrajectoryCommand> const& commands)
+    {
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.guid; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.handle; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.session; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.step; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.action; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.x; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.y; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.z; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.range; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.spell; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.target; });
+        columns.Column(commands, [](AITrajectoryCommand const& c) { return c.episode; });
+    }
+
+    uint64 NowUnixMs()
+    {
+        return uint64(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+AITrajectoryRecorder::AITrajectoryRecorder() : _enabled(false), _dropped(0), _failed(false), _stop(false), _segmentSize(0),
+    _base(nullptr), _capacity(0), _used(0), _startedMs(0), _segment(0)
+{
+}
+
+AITrajectoryRecorder::~AITrajectoryRecorder()
+{
+    Stop();
+}
+
+AITrajectoryRecorder* AITrajectoryRecorder::instance()
+{
+    static AITrajectoryRecorder instance;
+    return &instance;
+}
+
+void AITrajectoryRecorder::Configure(bool enabled, std::string const& directory, uint64 segmentSize)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _directory = directory.empty() ? std::filesystem::path("trajectories") : std::filesystem::path(directory);
+        _segmentSize = std::max(segmentSize, MinSegmentSize);
+    }
+
+    if (!enabled)
+    {
+        Stop();
+        return;
+    }
+
+    // Ein früherer Schreibfehler gilt nach .reload config nicht mehr; was davor noch
+    // in der Warteschlange lag, wird nicht nachträglich geschrieben
+    if (_failed.exchange(false))
+    {
+        std::deque<Job> stale;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            stale.swap(_jobs);
+        }
+        _commands.clear();
+    }
+
+    if (!_thread.joinable())
+    {
+        // Neue Aufnahme: eigener Dateiname
+        _startedMs = NowUnixMs();
+        _segment = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = false;
+        }
+        _thread = std::thread([this]() { Run(); });
+    }
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void AITrajectoryRecorder::Stop()
+{
+    _enabled.store(false, std::memory_order_relaxed);
+    _commands.clear();
+    if (!_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeup.notify_one();
+    _thread.join();
+}
+
+// --- WORLD-THREAD ---
+
+void AITrajectoryRecorder::RecordCommand(AICommand const& cmd, uint64 guid, uint32 handle)
+{
+    if (!IsEnabled())
+        return;
+
+    AITrajectoryCommand& rec = _commands.emplace_back();
+    rec.guid = guid;
+    rec.handle = handle;
+    rec.session = cmd.sessionId;
+    rec.step = cmd.stepId;
+    rec.action = uint8(cmd.action);
+    rec.x = cmd.x;
+    rec.y = cmd.y;
+    rec.z = cmd.z;
+    rec.range = cmd.range;
+    rec.spell = cmd.spellId;
+    rec.target = cmd.targetGuid;
+    rec.episode = cmd.episodeId;
+}
+
+void AITrajectoryRecorder::FlushCommands(uint64 version, uint64 timeMs)
+{
+    if (_commands.empty() || !IsEnabled())
+        return;
+
+    Job job;
+    job.commands.swap(_commands);
+    job.version = version;
+    job.timeMs = timeMs;
+    Enqueue(std::move(job));
+}
+
+void AITrajectoryRecorder::RecordState(AIStateSnapshotPtr const& snapshot, uint64 timeMs)
+{
+    if (!snapshot || !IsEnabled())
+        return;
+
+    // Nur eine Referenz mehr; der Builder nimmt den Puffer erst nach dem Schreiben wieder
+    Job job;
+    job.state = snapshot;
+    job.version = snapshot->version;
+    job.timeMs = timeMs;
+    Enqueue(std::move(job));
+}
+
+void AITrajectoryRecorder::Enqueue(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_jobs.size() >= MaxPendingJobs)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        _jobs.push_back(std::move(job));
+    }
+    _wakeup.notify_one();
+}
+
+// --- RECORDER-THREAD ---
+
+void AITrajectoryRecorder::Run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _wakeup.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+        // Bei Stop erst alles Wartende schreiben
+        if (_jobs.empty())
+            break;
+
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        lock.unlock();
+
+        if (!_failed.load())
+            Write(job);
+        if (uint32 dropped = _dropped.exchange(0, std::memory_order_relaxed))
+            LOG_ERROR("module", "AI-TRAJECTORY: Recorder kommt nicht hinterher, {} Records verworfen.", dropped);
+
+        // Snapshot außerhalb des Locks loslassen
+        job = Job();
+        lock.lock();
+    }
+    lock.unlock();
+
+    CloseSegment();
+}
+
+void AITrajectoryRecorder::Write(Job const& job)
+{
+    if (job.state)
+    {
+        AIStateSnapshot const& snapshot = *job.state;
+        AIColumnSizer sizer;
+        StateColumns(sizer, snapshot);
+        std::size_t payload = BlockHeaderSize + sizer.Size();
+
+        uint8* out = Reserve(payload);
+        if (!out)
+            return;
+        Put(out, job.version);
+        Put(out, job.timeMs);
+        Put(out, uint32(snapshot.players.size()));
+        Put(out, uint32(snapshot.mobs.size()));
+        AIColumnWriter writer(out);
+        StateColumns(writer, snapshot);
+        Commit(AI_TRAJ_RECORD_STATE, payload);
+        return;
+    }
+
+    AIColumnSizer sizer;
+    CommandColumns(sizer, job.commands);
+    std::size_t payload = BlockHeaderSize + sizer.Size();
+
+    uint8* out = Reserve(payload);
+    if (!out)
+        return;
+    Put(out, job.version);
+    Put(out, job.timeMs);
+    Put(out, uint32(job.commands.size()));
+    Put(out, uint32(0));
+    AIColumnWriter writer(out);
+    CommandColumns(writer, job.commands);
+    Commit(AI_TRAJ_RECORD_COMMANDS, payload);
+}
+
+uint8* AITrajectoryRecorder::Reserve(std::size_t payload)
+{
+    std::size_t needed = AI_TRAJ_RECORD_HEADER_SIZE + payload;
+    if (!_base || _used + needed > _capacity)
+    {
+        CloseSegment();
+        if (!OpenSegment(needed))
+            return nullptr;
+    }
+    return _base + _used + AI_TRAJ_RECORD_HEADER_SIZE;
+}
+
+void AITrajectoryRecorder::Commit(AITrajectoryRecordType type, std::size_t payload)
+{
+    uint8* header = _base + _used;
+    header[4] = type;
+
+    // Länge zuletzt: ein Leser, der die offene Datei mitliest, sieht nie einen halben Record
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32 length = uint32(payload);
+    std::memcpy(header, &length, sizeof(length));
+    _used += AI_TRAJ_RECORD_HEADER_SIZE + payload;
+}
+
+bool AITrajectoryRecorder::OpenSegment(std::size_t minSize)
+{
+    namespace bip = boost::interprocess;
+
+    std::filesystem::path directory;
+    uint64 segmentSize;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        directory = _directory;
+        segmentSize = _segmentSize;
+    }
+
+    // Ein einzelner Record größer als ein Segment bekommt ein eigenes, größeres
+    std::size_t size = std::max<std::size_t>(std::size_t(segmentSize), AI_TRAJ_FILE_HEADER_SIZE + minSize);
+    _path = directory / Acore::StringFormat("trajectory-{}-{:04}.aitr", _startedMs, _segment);
+    try
+    {
+        std::filesystem::create_directories(directory);
+        {
+            std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+        }
+        std::filesystem::resize_file(_path, size);
+        _file = std::make_unique<bip::file_mapping>(_path.string().c_str(), bip::read_write);
+        _region = std::make_unique<bip::mapped_region>(*_file, bip::read_write, 0, size);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_ERROR("module", "AI-TRAJECTORY: {} kann nicht geschrieben werden ({}), Aufnahme bis zum nächsten .reload config aus.", _path.string(), e.what());
+        _region.reset();
+        _file.reset();
+        // Der World-Thread soll nichts mehr einreihen, bis Configure die Aufnahme wieder einschaltet
+        _failed.store(true);
+        _enabled.store(false, std::memory_order_relaxed);
+        return false;
+    }
+
+    _base = static_cast<uint8*>(_region->get_address());
+    _capacity = size;
+
+    uint8* out = _base;
+    std::memcpy(out, TrajectoryMagic, sizeof(TrajectoryMagic));
+    out += sizeof(TrajectoryMagic);
+    Put(out, AI_TRAJ_FORMAT_VERSION);
+    Put(out, AI_TRAJ_FILE_HEADER_SIZE);
+    Put(out, NowUnixMs());
+    Put(out, _segment);
+    _used = AI_TRAJ_FILE_HEADER_SIZE;
+    ++_segment;
+
+    LOG_INFO("module", "AI-TRAJECTORY: Schreibe {}", _path.string());
+    return true;
+}
+
+void AITrajectoryRecorder::CloseSegment()
+{
+    if (!_region)
+        return;
+
+    _region->flush();
+    _region.reset();
+    _file.reset();
+    _base = nullptr;
+    _capacity = 0;
+
+    // Ungenutzten Rest abschneiden
+    std::error_code error;
+    std::filesystem::resize_file(_path, _used, error);
+    if (error)
+        LOG_ERROR("module", "AI-TRAJECTORY: {} konnte nicht gekürzt werden: {}", _path.string(), error.message());
+}
@@ -0,0 +1,165 @@
+/*
+ * Trajektorien-Recorder für Offline-RL.
+ *
+ * Schreibt jeden State-Snapshot und jedes angewendete Kommando in rotierende
+ * Binärdateien, die per mmap beschrieben werden. Trainer lesen sie später
+ * spaltenweise und ohne Kopie (apps/trajectory/ai_trajectory.py), statt den
+ * JSON-Stream mitzuschneiden und neu zu parsen; Floats bleiben bitgenau.
+ *
+ * Der World-Thread übergibt nur den Snapshot-Pointer bzw. die Kommandos des
+ * Ticks. Spalten bauen und schreiben macht ein eigener Recorder-Thread; kommt
+ * der nicht hinterher, wird verworfen statt den Tick zu bremsen.
+ *
+ * Dateiformat (little-endian, alles auf 8 Bytes ausgerichtet):
+ *
+ *   Header (AI_TRAJ_FILE_HEADER_SIZE):
+ *     char magic[8] "AITRAJ01", uint32 formatVersion, uint32 headerSize,
+ *     uint64 createdMs (Unix), uint32 segment, Rest 0
+ *
+ *   Records: uint32 length (Payload, Vielfaches von 8), uint8 type, uint8 pad[3], Payload.
+ *     Die Datei ist vorab mit 0 gefüllt und length wird zuletzt geschrieben;
+ *     length 0 heißt Ende der Daten, auch beim Mitlesen einer offenen Datei.
+ *
+ *   AI_TRAJ_RECORD_STATE:
+ *     uint64 version, uint64 timeMs, uint32 playerCount (n), uint32 mobCount (m),
+ *     dann je eine Spalte pro Feld, jede auf 8 Bytes aufgefüllt:
+ *       n x: guid u64, handle u32, hp u32, max_hp u32, power u32, max_power u32,
+ *            level u8, flags u8, free_slots u32, x f32, y f32, z f32, o f32,
+ *            target_status u8, target_hp u32, tx f32, ty f32, tz f32,
+ *            xp_gained u32, loot_copper u32, loot_score u32, mob_offset u32, mob_count u32
+ *       m x: mob_guid u64, mob_entry u32, mob_hp u32, mob_target u64,
+ *            mob_x f32, mob_y f32, mob_z f32, mob_level u8, mob_flags u8
+ *
+ *   AI_TRAJ_RECORD_COMMANDS (alle Kommandos eines Ticks):
+ *     uint64 version (letzter Snapshot davor), uint64 timeMs, uint32 count (n), uint32 pad,
+ *       n x: guid u64, handle u32, session u32, step u64, action u8,
+ *            x f32, y f32, z f32, range f32, spell u32, target u64, episode u64
+ *     Step-Marker (action 0, step != 0) schließen einen Step ab; der Text von
+ *     "say" wird nicht aufgezeichnet. checkpoint, reset und reset_batch stehen
+ *     einmal pro betroffenem Bot da, spawn mit handle 0xFFFFFFFF, solange der
+ *     Bot noch nicht eingeloggt ist.
+ */
+
+#ifndef MOD_AI_CONTROLLER_TRAJECTORY_H
+#define MOD_AI_CONTROLLER_TRAJECTORY_H
+
+#include "AIState.h"
+#include "Define.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct AICommand;
+
+namespace boost::interprocess
+{
+    class file_mapping;
+    class mapped_region;
+}
+
+enum AITrajectoryRecordType : uint8
+{
+    AI_TRAJ_RECORD_STATE    = 1,
+    AI_TRAJ_RECORD_COMMANDS = 2
+};
+
+constexpr uint32 AI_TRAJ_FORMAT_VERSION     = 1;
+constexpr uint32 AI_TRAJ_FILE_HEADER_SIZE   = 64;
+constexpr uint32 AI_TRAJ_RECORD_HEADER_SIZE = 8;
+
+// Ein angewendetes Kommando, aufgelöst auf den Bot
+struct AITrajectoryCommand
+{
+    uint64 guid = 0;
+    uint32 handle = 0xFFFFFFFF;
+    uint32 session = 0;
+    uint64 step = 0;
+    uint8 action = 0;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float range = 0.0f;
+    uint32 spell = 0;
+    uint64 target = 0;
+    uint64 episode = 0;
+};
+
+class AITrajectoryRecorder
+{
+public:
+    static AITrajectoryRecorder* instance();
+
+    // World-Thread (OnAfterConfigLoad): startet bzw. stoppt den Recorder-Thread,
+    // Verzeichnis und Segmentgröße gelten ab dem nächsten Segment
+    void Configure(bool enabled, std::string const& directory, uint64 segmentSize);
+
+    // Schreibt alles Wartende und schließt das offene Segment
+    void Stop();
+
+    bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    // Nur World-Thread
+    void RecordCommand(AICommand const& cmd, uint64 guid, uint32 handle);
+    void FlushCommands(uint64 version, uint64 timeMs);
+    void RecordState(AIStateSnapshotPtr const& snapshot, uint64 timeMs);
+
+    // Mehr wartende Records verwirft der World-Thread
+    static constexpr std::size_t MaxPendingJobs = 256;
+
+private:
+    AITrajectoryRecorder();
+    ~AITrajectoryRecorder();
+
+    struct Job
+    {
+        AIStateSnapshotPtr state;
+        std::vector<AITrajectoryCommand> commands;
+        uint64 version = 0;
+        uint64 timeMs = 0;
+    };
+
+    void Enqueue(Job&& job);
+
+    // Recorder-Thread
+    void Run();
+    void Write(Job const& job);
+    uint8* Reserve(std::size_t payload);
+    void Commit(AITrajectoryRecordType type, std::size_t payload);
+    bool OpenSegment(std::size_t minSize);
+    void CloseSegment();
+
+    std::atomic<bool> _enabled;
+    std::atomic<uint32> _dropped;
+    // Vom Recorder-Thread bei einem Schreibfehler gesetzt, von Configure zurückgesetzt
+    std::atomic<bool> _failed;
+
+    // Nur World-Thread
+    std::vector<AITrajectoryCommand> _commands;
+    std::thread _thread;
+
+    // Geschützt durch _mutex
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::deque<Job> _jobs;
+    bool _stop;
+    std::filesystem::path _directory;
+    uint64 _segmentSize;
+
+    // Nur Recorder-Thread
+    std::unique_ptr<boost::interprocess::file_mapping> _file;
+    std::unique_ptr<boost::interprocess::mapped_region> _region;
+    std::filesystem::path _path;
+    uint8* _base;
+    std::size_t _capacity;
+    std::size_t _used;
+    uint64 _startedMs;
+    uint32 _segment;
+};
+
+#define sAITrajectory AITrajectoryRecorder::instance()
+
+#endif